@@ -231,15 +231,60 @@ size_t get_image_size(unsigned int image_id)
 
 #if LOAD_IMAGE_V2
 
+#if TRUSTED_BOARD_BOOT
+/*
+ * Size of the pieces an image is read in when it is hashed as it gets loaded;
+ * small enough for each piece to be hashed while it is still in the cache.
+ */
+#define LOAD_HASH_CHUNK_SIZE	0x4000
+
+/*******************************************************************************
+ * Internal function to read an image and pass it to the authentication module
+ * as it comes in, one piece at a time.
+ ******************************************************************************/
+static int read_hashed_image(uintptr_t image_handle, uintptr_t image_base,
+			     size_t image_size, size_t *bytes_read)
+{
+	size_t chunk_size, chunk_read;
+	int io_result = 0;
+
+	*bytes_read = 0;
+
+	while (*bytes_read < image_size) {
+		chunk_size = image_size - *bytes_read;
+		if (chunk_size > LOAD_HASH_CHUNK_SIZE)
+			chunk_size = LOAD_HASH_CHUNK_SIZE;
+
+		io_result = io_read(image_handle, image_base + *bytes_read,
+				    chunk_size, &chunk_read);
+		if ((io_result != 0) || (chunk_read == 0))
+			break;
+
+		io_result = auth_mod_hash_update(
+				(void *)(image_base + *bytes_read), chunk_read);
+		if (io_result != 0) {
+			io_result = -EAUTH;
+			break;
+		}
+
+		*bytes_read += chunk_read;
+	}
+
+	return io_result;
+}
+#endif /* TRUSTED_BOARD_BOOT */
+
 /*******************************************************************************
  * Internal function to load an image at a specific address given
- * an image ID and extents of free memory.
+ * an image ID and extents of free memory. If hash_on_load is set, the image is
+ * also hashed as it gets loaded (see auth_mod_hash_start()).
  *
  * If the load is successful then the image information is updated.
  *
  * Returns 0 on success, a negative error code otherwise.
  ******************************************************************************/
-static int load_image(unsigned int image_id, image_info_t *image_data)
+static int load_image(unsigned int image_id, image_info_t *image_data,
+		      int hash_on_load)
 {
 	uintptr_t dev_handle;
 	uintptr_t image_handle;
@@ -292,6 +337,12 @@ static int load_image(unsigned int image_id, image_info_t *image_data)
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
+#if TRUSTED_BOARD_BOOT
+	if (hash_on_load)
+		io_result = read_hashed_image(image_handle, image_base,
+					      image_size, &bytes_read);
+	else
+#endif
 	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
@@ -316,6 +367,7 @@ static int load_auth_image_internal(unsigned int image_id,
 				    image_info_t *image_data,
 				    int is_parent_image)
 {
+	int hash_on_load = 0;
 	int rc;
 
 #if TRUSTED_BOARD_BOOT
@@ -330,11 +382,14 @@ static int load_auth_image_internal(unsigned int image_id,
 				return rc;
 			}
 		}
+
+		/* Hash the image as it gets loaded, if possible */
+		hash_on_load = (auth_mod_hash_start(image_id) == 0);
 	}
 #endif /* TRUSTED_BOARD_BOOT */
 
 	/* Load the image */
-	rc = load_image(image_id, image_data);
+	rc = load_image(image_id, image_data, hash_on_load);
 	if (rc != 0) {
 		return rc;
 	}
@@ -32,6 +32,9 @@
 extern const auth_img_desc_t *const cot_desc_ptr;
 extern unsigned int auth_img_flags[MAX_NUMBER_IDS];
 
+/* Image whose hash is being computed while it gets loaded, if any */
+static const auth_img_desc_t *hash_on_load_img;
+
 static int cmp_auth_param_type_desc(const auth_param_type_desc_t *a,
 		const auth_param_type_desc_t *b)
 {
@@ -102,6 +105,12 @@ static int auth_hash(const auth_method_param_hash_t *param,
 			&hash_der_ptr, &hash_der_len);
 	return_if_error(rc);
 
+	/* If the image was hashed as it was loaded, just check the result */
+	if (img_desc == hash_on_load_img) {
+		hash_on_load_img = NULL;
+		return crypto_mod_verify_hash_end(hash_der_ptr, hash_der_len);
+	}
+
 	/* Get the data to be hashed from the current image */
 	rc = img_parser_get_auth_param(img_desc->img_type, param->data,
 			img, img_len, &data_ptr, &data_len);
@@ -320,6 +329,65 @@ int auth_mod_get_parent_id(unsigned int img_id, unsigned int *parent_id)
 	return 0;
 }
 
+/*
+ * Start hashing an image which is about to be loaded, so that the loader can
+ * pass its data to auth_mod_hash_update() while it is still in the cache and
+ * auth_mod_verify_img() then doesn't need to hash the whole image again.
+ *
+ * This only works for raw images authenticated by a hash found in a parent
+ * which has already been authenticated. Return 0 if the hash was started,
+ * otherwise the image is hashed by auth_mod_verify_img() as usual.
+ */
+int auth_mod_hash_start(unsigned int img_id)
+{
+	const auth_img_desc_t *img_desc = NULL;
+	const auth_method_desc_t *auth_method = NULL;
+	void *hash_der_ptr;
+	unsigned int hash_der_len;
+	int rc, i;
+
+	hash_on_load_img = NULL;
+
+	/* Get the image descriptor from the chain of trust */
+	img_desc = &cot_desc_ptr[img_id];
+
+	/* The hash of other image types only covers part of the image */
+	if ((img_desc->img_type != IMG_RAW) || (img_desc->parent == NULL)) {
+		return 1;
+	}
+
+	for (i = 0 ; i < AUTH_METHOD_NUM ; i++) {
+		auth_method = &img_desc->img_auth_methods[i];
+		if (auth_method->type == AUTH_METHOD_HASH) {
+			break;
+		}
+	}
+	if (i == AUTH_METHOD_NUM) {
+		return 1;
+	}
+
+	rc = auth_get_param(auth_method->param.hash.hash, img_desc->parent,
+			&hash_der_ptr, &hash_der_len);
+	return_if_error(rc);
+
+	rc = crypto_mod_hash_start(hash_der_ptr, hash_der_len);
+	return_if_error(rc);
+
+	hash_on_load_img = img_desc;
+
+	return 0;
+}
+
+/*
+ * Pass the next piece of the image started with auth_mod_hash_start()
+ */
+int auth_mod_hash_update(void *data_ptr, unsigned int data_len)
+{
+	assert(hash_on_load_img != NULL);
+
+	return crypto_mod_hash_update(data_ptr, data_len);
+}
+
 /*
  * Initialize the different modules in the authentication framework
  */
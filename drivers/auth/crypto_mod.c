@@ -102,3 +102,57 @@ int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 	return crypto_lib_desc.verify_hash(data_ptr, data_len,
 					   digest_info_ptr, digest_info_len);
 }
+
+/*
+ * Start hashing data which is going to be passed a piece at a time
+ *
+ * Parameters:
+ *
+ *   digest_info_ptr, digest_info_len: hash to be compared in the end, which
+ *                                     gives the algorithm to use
+ */
+int crypto_mod_hash_start(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	assert(digest_info_ptr != NULL);
+	assert(digest_info_len != 0);
+
+	/* Not every library can do this; the caller then uses verify_hash */
+	if (crypto_lib_desc.hash_start == NULL) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return crypto_lib_desc.hash_start(digest_info_ptr, digest_info_len);
+}
+
+/*
+ * Add data to the hash started by crypto_mod_hash_start()
+ *
+ * Parameters:
+ *
+ *   data_ptr, data_len: data to be hashed
+ */
+int crypto_mod_hash_update(void *data_ptr, unsigned int data_len)
+{
+	assert(data_ptr != NULL);
+	assert(crypto_lib_desc.hash_update != NULL);
+
+	return crypto_lib_desc.hash_update(data_ptr, data_len);
+}
+
+/*
+ * Verify the hash started by crypto_mod_hash_start() by comparison
+ *
+ * Parameters:
+ *
+ *   digest_info_ptr, digest_info_len: hash to be compared
+ */
+int crypto_mod_verify_hash_end(void *digest_info_ptr,
+			       unsigned int digest_info_len)
+{
+	assert(digest_info_ptr != NULL);
+	assert(digest_info_len != 0);
+	assert(crypto_lib_desc.verify_hash_end != NULL);
+
+	return crypto_lib_desc.verify_hash_end(digest_info_ptr,
+					       digest_info_len);
+}
@@ -135,19 +135,18 @@ end2:
 }
 
 /*
- * Match a hash
+ * Get the hash algorithm and the hash out of a digest info
  *
  * Digest info is passed in DER format following the ASN.1 structure detailed
  * above.
  */
-static int verify_hash(void *data_ptr, unsigned int data_len,
-		       void *digest_info_ptr, unsigned int digest_info_len)
+static int get_digest_info(void *digest_info_ptr, unsigned int digest_info_len,
+			   const mbedtls_md_info_t **md_info,
+			   unsigned char **hash)
 {
 	mbedtls_asn1_buf hash_oid, params;
 	mbedtls_md_type_t md_alg;
-	const mbedtls_md_info_t *md_info;
-	unsigned char *p, *end, *hash;
-	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	unsigned char *p, *end;
 	size_t len;
 	int rc;
 
@@ -171,8 +170,8 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 		return CRYPTO_ERR_HASH;
 	}
 
-	md_info = mbedtls_md_info_from_type(md_alg);
-	if (md_info == NULL) {
+	*md_info = mbedtls_md_info_from_type(md_alg);
+	if (*md_info == NULL) {
 		return CRYPTO_ERR_HASH;
 	}
 
@@ -183,10 +182,29 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	}
 
 	/* Length of hash must match the algorithm's size */
-	if (len != mbedtls_md_get_size(md_info)) {
+	if (len != mbedtls_md_get_size(*md_info)) {
 		return CRYPTO_ERR_HASH;
 	}
-	hash = p;
+	*hash = p;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Match a hash
+ */
+static int verify_hash(void *data_ptr, unsigned int data_len,
+		       void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *p, *hash;
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc != CRYPTO_SUCCESS) {
+		return rc;
+	}
 
 	/* Calculate the hash of the data */
 	p = (unsigned char *)data_ptr;
@@ -204,7 +222,89 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	return CRYPTO_SUCCESS;
 }
 
+/*
+ * Hash on load: the context of the hash being computed while an image gets
+ * loaded, one piece at a time
+ */
+static mbedtls_md_context_t load_md_ctx;
+static int load_md_active;
+
+static int hash_start(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *hash;
+	int rc;
+
+	/* Drop the hash of an image whose loading failed */
+	if (load_md_active) {
+		mbedtls_md_free(&load_md_ctx);
+		load_md_active = 0;
+	}
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc != CRYPTO_SUCCESS) {
+		return rc;
+	}
+
+	mbedtls_md_init(&load_md_ctx);
+	rc = mbedtls_md_setup(&load_md_ctx, md_info, 0);
+	if (rc == 0) {
+		rc = mbedtls_md_starts(&load_md_ctx);
+	}
+	if (rc != 0) {
+		mbedtls_md_free(&load_md_ctx);
+		return CRYPTO_ERR_HASH;
+	}
+
+	load_md_active = 1;
+
+	return CRYPTO_SUCCESS;
+}
+
+static int hash_update(void *data_ptr, unsigned int data_len)
+{
+	if (!load_md_active) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	if (mbedtls_md_update(&load_md_ctx, (unsigned char *)data_ptr,
+			      data_len) != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+static int verify_hash_end(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *hash;
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	if (!load_md_active) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &md_info, &hash);
+	if (rc == CRYPTO_SUCCESS) {
+		/* The algorithm must be the one the hash was started with */
+		if ((md_info != load_md_ctx.md_info) ||
+		    (mbedtls_md_finish(&load_md_ctx, data_hash) != 0) ||
+		    (memcmp(data_hash, hash,
+			    mbedtls_md_get_size(md_info)) != 0)) {
+			rc = CRYPTO_ERR_HASH;
+		}
+	}
+
+	mbedtls_md_free(&load_md_ctx);
+	load_md_active = 0;
+
+	return rc;
+}
+
 /*
  * Register crypto library descriptor
  */
-REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash);
+REGISTER_CRYPTO_LIB_HASH_ON_LOAD(LIB_NAME, init, verify_signature, verify_hash,
+				 hash_start, hash_update, verify_hash_end);
@@ -97,6 +97,11 @@
 
 #define DWMMC_DBADDR			(0x88)
 #define DWMMC_IDSTS			(0x8c)
+#define IDSTS_CES			(1 << 5)
+#define IDSTS_DU			(1 << 4)
+#define IDSTS_FBE			(1 << 2)
+#define IDSTS_RI			(1 << 1)
+#define IDSTS_TI			(1 << 0)
 #define DWMMC_IDINTEN			(0x90)
 #define DWMMC_CARDTHRCTL		(0x100)
 #define CARDTHRCTL_RD_THR(x)		((x & 0xfff) << 16)
@@ -384,7 +389,7 @@ static void init_dma(uintptr_t buf, size_t size)
 
 	desc_cnt = (size + DWMMC_DMA_MAX_BUFFER_SIZE - 1) /
 		   DWMMC_DMA_MAX_BUFFER_SIZE;
-	assert(desc_cnt * sizeof(struct dw_idmac_desc) < dw_params.desc_size);
+	assert(desc_cnt * sizeof(struct dw_idmac_desc) <= dw_params.desc_size);
 
 	base = dw_params.reg_base;
 	desc = (struct dw_idmac_desc *)dw_params.desc_base;
@@ -406,12 +411,44 @@ static void init_dma(uintptr_t buf, size_t size)
 	/* set next descriptor address as 0 */
 	(desc + last)->des3 = 0;
 
-	mmio_write_32(base + DWMMC_DBADDR, dw_params.desc_base);
+	/* The IDMAC doesn't snoop the caches; push the descriptors out */
 	clean_dcache_range(dw_params.desc_base,
-			   desc_cnt * DWMMC_DMA_MAX_BUFFER_SIZE);
+			   desc_cnt * sizeof(struct dw_idmac_desc));
+	mmio_write_32(base + DWMMC_IDSTS, ~0);
+	mmio_write_32(base + DWMMC_DBADDR, dw_params.desc_base);
 #endif
 }
 
+#ifndef DWMMC_NO_DMA
+/*
+ * Wait for the IDMAC to be done with the data of the current command;
+ * send_cmd() only waits for the command itself.
+ */
+static int dw_wait_dma(unsigned int done)
+{
+	uintptr_t base = dw_params.reg_base;
+	unsigned int data;
+	int timeout = TIMEOUT;
+
+	do {
+		data = mmio_read_32(base + DWMMC_IDSTS);
+		if (data & (IDSTS_CES | IDSTS_DU | IDSTS_FBE)) {
+			ERROR("%s, IDSTS:0x%x\n", __func__, data);
+			return -EIO;
+		}
+		if (--timeout == 0) {
+			ERROR("%s, IDSTS:0x%x\n", __func__, data);
+			return -ETIMEDOUT;
+		}
+		if (!(data & done))
+			udelay(10);
+	} while (!(data & done));
+
+	mmio_write_32(base + DWMMC_IDSTS, ~0);
+	return 0;
+}
+#endif
+
 static int dw_prepare(int lba, uintptr_t buf, size_t size)
 {
 	uintptr_t base = dw_params.reg_base;
@@ -447,6 +484,14 @@ static int dw_read(int lba, uintptr_t buf, size_t size)
 
 	for (; size; size -= 4, ++p)
 		*p = mmio_read_32(base + DWMMC_FIFO);
+#else
+	int ret = dw_wait_dma(IDSTS_RI);
+
+	if (ret)
+		return ret;
+
+	/* Drop any line speculatively fetched while the data came in */
+	inv_dcache_range(buf, size);
 #endif
 
 	return 0;
@@ -454,7 +499,11 @@ static int dw_read(int lba, uintptr_t buf, size_t size)
 
 static int dw_write(int lba, uintptr_t buf, size_t size)
 {
+#ifndef DWMMC_NO_DMA
+	return dw_wait_dma(IDSTS_TI);
+#else
 	return 0;
+#endif
 }
 
 void dw_mmc_init(dw_mmc_params_t *params)
@@ -37,6 +37,15 @@ typedef struct crypto_lib_desc_s {
 	/* Verify a hash. Return one of the 'enum crypto_ret_value' options */
 	int (*verify_hash)(void *data_ptr, unsigned int data_len,
 			   void *digest_info_ptr, unsigned int digest_info_len);
+
+	/* Optionally, verify a hash of data fed a piece at a time, as it gets
+	 * loaded: start hashing with the algorithm of the digest info, add
+	 * data, then compare the result with the digest info. Return one of
+	 * the 'enum crypto_ret_value' options */
+	int (*hash_start)(void *digest_info_ptr, unsigned int digest_info_len);
+	int (*hash_update)(void *data_ptr, unsigned int data_len);
+	int (*verify_hash_end)(void *digest_info_ptr,
+			       unsigned int digest_info_len);
 } crypto_lib_desc_t;
 
 /* Public functions */
@@ -47,6 +56,10 @@ int crypto_mod_verify_signature(void *data_ptr, unsigned int data_len,
 				void *pk_ptr, unsigned int pk_len);
 int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 			   void *digest_info_ptr, unsigned int digest_info_len);
+int crypto_mod_hash_start(void *digest_info_ptr, unsigned int digest_info_len);
+int crypto_mod_hash_update(void *data_ptr, unsigned int data_len);
+int crypto_mod_verify_hash_end(void *digest_info_ptr,
+			       unsigned int digest_info_len);
 
 /* Macro to register a cryptographic library */
 #define REGISTER_CRYPTO_LIB(_name, _init, _verify_signature, _verify_hash) \
@@ -57,6 +70,20 @@ int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 		.verify_hash = _verify_hash \
 	}
 
+/* Macro to register a cryptographic library which can also hash on load */
+#define REGISTER_CRYPTO_LIB_HASH_ON_LOAD(_name, _init, _verify_signature, \
+					 _verify_hash, _hash_start, \
+					 _hash_update, _verify_hash_end) \
+	const crypto_lib_desc_t crypto_lib_desc = { \
+		.name = _name, \
+		.init = _init, \
+		.verify_signature = _verify_signature, \
+		.verify_hash = _verify_hash, \
+		.hash_start = _hash_start, \
+		.hash_update = _hash_update, \
+		.verify_hash_end = _verify_hash_end \
+	}
+
 extern const crypto_lib_desc_t crypto_lib_desc;
 
 #endif /* __CRYPTO_MOD_H__ */
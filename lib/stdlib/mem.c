@@ -5,13 +5,54 @@
  */
 
 #include <stddef.h> /* size_t */
+#include <stdint.h> /* uintptr_t */
+
+/*
+ * The bulk of the work below is done a native word at a time, two words
+ * per iteration so that AArch64 builds use LDP/STP. Words are only ever
+ * accessed at word aligned addresses, so these functions stay safe with
+ * strict alignment checking and with the MMU off. Buffers which cannot
+ * be mutually aligned fall back to byte accesses.
+ */
+typedef unsigned long __attribute__((__may_alias__)) mem_word_t;
+
+#define MEM_WORD_SIZE		sizeof(mem_word_t)
+#define MEM_WORD_MASK		(MEM_WORD_SIZE - 1)
+
+#define mem_word_aligned(p)	(((uintptr_t)(p) & MEM_WORD_MASK) == 0)
 
 /*
  * Fill @count bytes of memory pointed to by @dst with @val
  */
 void *memset(void *dst, int val, size_t count)
 {
-	char *ptr = dst;
+	unsigned char *ptr = dst;
+	mem_word_t *wptr;
+	mem_word_t wval;
+
+	while (count && !mem_word_aligned(ptr)) {
+		*ptr++ = val;
+		count--;
+	}
+
+	if (count >= MEM_WORD_SIZE) {
+		wval = (unsigned char)val;
+		wval |= wval << 8;
+		wval |= wval << 16;
+		wval |= (wval << 16) << 16;
+
+		wptr = (mem_word_t *)ptr;
+		for (; count >= 2 * MEM_WORD_SIZE; count -= 2 * MEM_WORD_SIZE) {
+			wptr[0] = wval;
+			wptr[1] = wval;
+			wptr += 2;
+		}
+		if (count >= MEM_WORD_SIZE) {
+			*wptr++ = wval;
+			count -= MEM_WORD_SIZE;
+		}
+		ptr = (unsigned char *)wptr;
+	}
 
 	while (count--)
 		*ptr++ = val;
@@ -44,8 +85,35 @@ int memcmp(const void *s1, const void *s2, size_t len)
  */
 void *memcpy(void *dst, const void *src, size_t len)
 {
-	const char *s = src;
-	char *d = dst;
+	const unsigned char *s = src;
+	unsigned char *d = dst;
+	const mem_word_t *ws;
+	mem_word_t *wd;
+	mem_word_t w0, w1;
+
+	if (mem_word_aligned((uintptr_t)d ^ (uintptr_t)s)) {
+		while (len && !mem_word_aligned(d)) {
+			*d++ = *s++;
+			len--;
+		}
+
+		ws = (const mem_word_t *)s;
+		wd = (mem_word_t *)d;
+		for (; len >= 2 * MEM_WORD_SIZE; len -= 2 * MEM_WORD_SIZE) {
+			w0 = ws[0];
+			w1 = ws[1];
+			wd[0] = w0;
+			wd[1] = w1;
+			ws += 2;
+			wd += 2;
+		}
+		if (len >= MEM_WORD_SIZE) {
+			*wd++ = *ws++;
+			len -= MEM_WORD_SIZE;
+		}
+		s = (const unsigned char *)ws;
+		d = (unsigned char *)wd;
+	}
 
 	while (len--)
 		*d++ = *s++;
@@ -71,10 +139,38 @@ void *memmove(void *dst, const void *src, size_t len)
 		return memcpy(dst, src, len);
 	} else {
 		/* copy backwards... */
-		const char *end = dst;
-		const char *s = (const char *)src + len;
-		char *d = (char *)dst + len;
-		while (d != end)
+		const unsigned char *s = (const unsigned char *)src + len;
+		unsigned char *d = (unsigned char *)dst + len;
+		const mem_word_t *ws;
+		mem_word_t *wd;
+		mem_word_t w0, w1;
+
+		if (mem_word_aligned((uintptr_t)d ^ (uintptr_t)s)) {
+			while (len && !mem_word_aligned(d)) {
+				*--d = *--s;
+				len--;
+			}
+
+			ws = (const mem_word_t *)s;
+			wd = (mem_word_t *)d;
+			for (; len >= 2 * MEM_WORD_SIZE;
+			     len -= 2 * MEM_WORD_SIZE) {
+				ws -= 2;
+				wd -= 2;
+				w1 = ws[1];
+				w0 = ws[0];
+				wd[1] = w1;
+				wd[0] = w0;
+			}
+			if (len >= MEM_WORD_SIZE) {
+				*--wd = *--ws;
+				len -= MEM_WORD_SIZE;
+			}
+			s = (const unsigned char *)ws;
+			d = (unsigned char *)wd;
+		}
+
+		while (len--)
 			*--d = *--s;
 	}
 	return dst;
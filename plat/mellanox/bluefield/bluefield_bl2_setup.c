@@ -37,6 +37,8 @@
 #include <mmio.h>
 #include <platform_def.h>
 #include <string.h>
+#include "bluefield_boot_log.h"
+#include "bluefield_boot_trace.h"
 #include "bluefield_def.h"
 #include "bluefield_private.h"
 #include "bluefield_system.h"
@@ -82,6 +84,9 @@ struct bf_mem_info bf_memory_layout;
  ******************************************************************************/
 void bl2_early_platform_setup(meminfo_t *mem_layout)
 {
+	/* Start tracing the boot time as early as we can */
+	bf_boot_ts_init();
+
 	/* Initialize the console to provide early debug support */
 	bluefield_console_init();
 
@@ -291,6 +296,11 @@ void bluefield_setup_memory(struct bf_dev_tbl *dev_tbl,
 {
 	int mem_ctrl_num = 0;
 	int have_mem = 0;
+	int mem_ok[MAX_MEM_CTRL] = { 0 };
+	uint32_t mem_failed;
+
+	/* Train the memory controllers in parallel if we can. */
+	ddr_engine_begin();
 
 	for (int idx = 0; dev_tbl[idx].base_addr != ~0ULL; idx++) {
 		if (dev_tbl[idx].dev_type != DEV_MSS)
@@ -300,12 +310,24 @@ void bluefield_setup_memory(struct bf_dev_tbl *dev_tbl,
 			continue;
 		}
 		assert(mem_ctrl_num < MAX_MEM_CTRL);
-		have_mem |= bf_sys_mem_config(dev_tbl[idx].base_addr,
+		mem_ok[mem_ctrl_num] = bf_sys_mem_config(
+				  dev_tbl[idx].base_addr,
 				  &(bmi->mem_ctrl_info[mem_ctrl_num]),
 				  mem_ctrl_num);
 		mem_ctrl_num++;
 	}
 
+	/* Forget about the memory controllers whose training failed. */
+	mem_failed = ddr_engine_run();
+	for (int i = 0; i < MAX_MEM_CTRL; i++) {
+		if ((mem_failed >> i) & 1) {
+			mem_ok[i] = 0;
+			memset(&(bmi->mem_ctrl_info[i]), 0,
+			       sizeof(bmi->mem_ctrl_info[i]));
+		}
+		have_mem |= mem_ok[i];
+	}
+
 # ifndef ATF_CONSOLE
 	/*
 	 * If no memory was brought up, try a second time with the lowest
@@ -349,12 +371,14 @@ void bl2_platform_setup(void)
 	bluefield_get_dev_tbl(&bdt, &disabled_devs);
 
 	bf_sys_setup_sam(bdt, disabled_devs);
+	bf_boot_ts_record(BF_TS_SAM_DONE);
 
 #if TRUSTED_BOARD_BOOT
 	if (!plat_enable_tbb())
 		dyn_disable_auth();
 
 	bluefield_auth_hca_firmware();
+	bf_boot_ts_record(BF_TS_HCA_AUTH_DONE);
 #endif
 
 	memset(&bf_memory_layout, 0, sizeof(bf_memory_layout));
@@ -367,17 +391,25 @@ void bl2_platform_setup(void)
 
 	bf_sys_setup_interrupts(bdt, disabled_devs);
 
+	bf_boot_ts_record(BF_TS_MEM_START);
 	bluefield_setup_memory(bdt, disabled_devs, &bf_memory_layout);
+	bf_boot_ts_record(BF_TS_MEM_DONE);
 
 	bluefield_console();
 
 	bf_sys_setup_pmr(bdt, disabled_devs, &bf_memory_layout, 0);
+	bf_boot_ts_record(BF_TS_PMR_DONE);
+
+	/* The DRAM is now mapped, move the boot log over there. */
+	bf_boot_log_start(BF_BOOT_LOG_BASE);
 
 	bf_sys_setup_hnf_errata(bdt, disabled_devs);
 
 	bf_sys_setup_trio(bdt, disabled_devs);
+	bf_boot_ts_record(BF_TS_TRIO_DONE);
 
 	bluefield_setup_nvdimm_restore();
+	bf_boot_ts_record(BF_TS_NVDIMM_RESTORE_DONE);
 #else /* ALT_BL2 */
 	bluefield_mod_fuses();
 #endif /* ALT_BL2 */
@@ -402,6 +434,17 @@ void bl2_plat_arch_setup(void)
 	enable_mmu_el1(0);
 }
 
+/*******************************************************************************
+ * Record when the loading of `image_id` starts, for the boot time trace.
+ ******************************************************************************/
+int bl2_plat_handle_pre_image_load(unsigned int image_id)
+{
+	if (image_id < BF_TS_IMAGE_ID_NUM)
+		bf_boot_ts_record(BF_TS_IMAGE_LOAD_START(image_id));
+
+	return 0;
+}
+
 /*******************************************************************************
  * This function can be used by the platforms to update/use image
  * information for given `image_id`.
@@ -412,6 +455,9 @@ int bl2_plat_handle_post_image_load(unsigned int image_id)
 	bl_mem_params_node_t *bl_mem_params = get_bl_mem_params_node(image_id);
 	assert(bl_mem_params);
 
+	if (image_id < BF_TS_IMAGE_ID_NUM)
+		bf_boot_ts_record(BF_TS_IMAGE_LOAD_END(image_id));
+
 	switch (image_id) {
 	case BL33_IMAGE_ID:
 		/* BL33 expects to receive the primary CPU MPID (through r0) */
@@ -39,6 +39,8 @@
 #include <mmio.h>
 #include <platform.h>
 #include <platform_def.h>
+#include "bluefield_boot_trace.h"
+#include "bluefield_ecc.h"
 #include "bluefield_private.h"
 #include "bluefield_system.h"
 
@@ -90,6 +92,8 @@ entry_point_info_t *bl31_plat_get_next_image_ep_info(uint32_t type)
 void bl31_early_platform_setup(void *from_bl2,
 			       void *plat_params_from_bl2)
 {
+	bf_boot_ts_record(BF_TS_BL31_ENTRY);
+
 	/* Initialize the console to provide early debug support */
 	bluefield_console_init();
 
@@ -178,6 +182,29 @@ void bl31_platform_setup(void)
 
 	/* Initialize the irq handler. */
 	bluefield_irq_init();
+
+	/* Start collecting the DRAM ECC errors. */
+	bf_ecc_init();
+
+	bf_boot_ts_record(BF_TS_BL31_PLAT_SETUP_DONE);
+}
+
+/*******************************************************************************
+ * Called right before exiting to BL33. Close the boot time trace and print
+ * it while the boot console is still usable.
+ ******************************************************************************/
+void bl31_plat_runtime_setup(void)
+{
+	bf_boot_ts_record(BF_TS_BL31_RUNTIME_SETUP);
+
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+	VERBOSE("Boot time trace:\n");
+	bf_boot_ts_dump();
+#endif
+
+	/* The boot log stops here, make sure all of it is in DRAM. */
+	console_flush();
+	console_switch_state(CONSOLE_FLAG_RUNTIME);
 }
 
 /*******************************************************************************
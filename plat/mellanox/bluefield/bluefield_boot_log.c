@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arch_helpers.h>
+#include <console.h>
+#include <debug.h>
+#include <platform.h>
+#include <utils_def.h>
+#include "bluefield_boot_log.h"
+
+/* Console registration, see tmfifo_console.c. */
+int console_register(console_t *console);
+
+/* Wrappers around bf_boot_log_putc() and bf_boot_log_flush(). */
+int console_boot_log_putc(int character, console_t *console);
+int console_boot_log_flush(console_t *console);
+
+/* Size of the text area following the boot log header. */
+#define BF_BOOT_LOG_TEXT_SIZE	(BF_BOOT_LOG_SIZE - sizeof(struct bf_boot_log))
+
+static console_t bf_log_console;
+
+/*
+ * The boot log in DRAM, or NULL while we are still staging. Its header is
+ * only ever written here: the indexes used to store into the text are our
+ * own copies, which are published to the header but never read back.
+ */
+static struct bf_boot_log *bf_log;
+static uint64_t bf_log_head;
+static uint64_t bf_log_lost;
+/* Last value of bf_log_head flushed to memory. */
+static uint64_t bf_log_flushed;
+
+static char bf_log_stage[BF_BOOT_LOG_STAGE_SIZE];
+/* Free running index of the next char to stage. */
+static unsigned int bf_log_stage_head;
+
+/* Set when the next char starts a new line and needs a timestamp. */
+static int bf_log_line_start = 1;
+/* Set while the current record only goes to the boot log. */
+static int bf_log_quiet;
+
+static void bf_boot_log_add(char c)
+{
+	if (bf_log != NULL)
+		bf_log->text[bf_log_head++ % BF_BOOT_LOG_TEXT_SIZE] = c;
+	else
+		bf_log_stage[bf_log_stage_head++ &
+			     (BF_BOOT_LOG_STAGE_SIZE - 1)] = c;
+}
+
+/* Add a decimal number, padded to 'width' digits with 'pad'. */
+static void bf_boot_log_add_num(uint64_t num, int width, char pad)
+{
+	char buf[20];
+	int i = 0;
+
+	do {
+		buf[i++] = '0' + num % 10;
+		num /= 10;
+	} while (num);
+
+	while (width-- > i)
+		bf_boot_log_add(pad);
+	while (--i >= 0)
+		bf_boot_log_add(buf[i]);
+}
+
+/* Start a line with the time since reset, e.g. "[    2.012345] ". */
+static void bf_boot_log_add_ts(void)
+{
+	uint64_t freq = plat_get_syscnt_freq2();
+	uint64_t ts = read_cntpct_el0();
+
+	bf_boot_log_add('[');
+	bf_boot_log_add_num(ts / freq, 5, ' ');
+	bf_boot_log_add('.');
+	bf_boot_log_add_num((ts % freq) * 1000000 / freq, 6, '0');
+	bf_boot_log_add(']');
+	bf_boot_log_add(' ');
+}
+
+int bf_boot_log_putc(int character, console_t *console)
+{
+	if (bf_log_line_start) {
+		bf_log_line_start = 0;
+		bf_boot_log_add_ts();
+	}
+
+	/* Lines end with "\r\n" on the other consoles, here just "\n". */
+	if (character != '\r')
+		bf_boot_log_add(character);
+
+	if (character == '\n') {
+		bf_log_line_start = 1;
+		/*
+		 * We are the last console in the list so the other consoles
+		 * have skipped this newline already.
+		 */
+		bf_boot_log_record_end();
+	}
+
+	return character;
+}
+
+/* Write back whatever was added to the DRAM log since the last flush. */
+int bf_boot_log_flush(console_t *console)
+{
+	uint64_t start, len;
+
+	if (bf_log == NULL)
+		return 0;
+
+	len = MIN(bf_log_head - bf_log_flushed,
+		  (uint64_t)BF_BOOT_LOG_TEXT_SIZE);
+	start = (bf_log_head - len) % BF_BOOT_LOG_TEXT_SIZE;
+
+	if (start + len > BF_BOOT_LOG_TEXT_SIZE) {
+		flush_dcache_range((uintptr_t)&bf_log->text[start],
+				   BF_BOOT_LOG_TEXT_SIZE - start);
+		len -= BF_BOOT_LOG_TEXT_SIZE - start;
+		start = 0;
+	}
+	flush_dcache_range((uintptr_t)&bf_log->text[start], len);
+
+	bf_log->head = bf_log_head;
+	bf_log->lost = bf_log_lost;
+	flush_dcache_range((uintptr_t)bf_log, sizeof(*bf_log));
+
+	bf_log_flushed = bf_log_head;
+
+	return 0;
+}
+
+/*
+ * Register the boot log console, with the output staged until the DRAM log
+ * is set up. This must be the first console registered so that it's the last
+ * one in the list, see bf_boot_log_putc(). The log is not kept at runtime:
+ * by then the DRAM it lives in belongs to the normal world.
+ */
+void bf_boot_log_register(void)
+{
+	bf_log_console.putc = console_boot_log_putc;
+	bf_log_console.getc = NULL;
+	bf_log_console.flush = console_boot_log_flush;
+	bf_log_console.flags = CONSOLE_FLAG_BOOT | BF_CONSOLE_FLAG_LOG_ONLY;
+
+	console_register(&bf_log_console);
+}
+
+/*
+ * Move what was staged so far to the DRAM log, which has 'head' and 'lost'
+ * as its indexes, and switch over to it.
+ */
+static void bf_boot_log_unstage(struct bf_boot_log *log, uint64_t head,
+				uint64_t lost)
+{
+	unsigned int len = MIN(bf_log_stage_head,
+			       (unsigned int)BF_BOOT_LOG_STAGE_SIZE);
+
+	lost += bf_log_stage_head - len;
+
+	/*
+	 * Byte by byte as BL31 gets here with the MMU off, where unaligned
+	 * accesses to the DRAM would fault.
+	 */
+	for (unsigned int i = bf_log_stage_head - len;
+	     i != bf_log_stage_head; i++)
+		log->text[head++ % BF_BOOT_LOG_TEXT_SIZE] =
+			bf_log_stage[i & (BF_BOOT_LOG_STAGE_SIZE - 1)];
+
+	log->head = head;
+	log->lost = lost;
+
+	bf_log_head = head;
+	bf_log_lost = lost;
+	bf_log_flushed = head - MIN(head, (uint64_t)BF_BOOT_LOG_TEXT_SIZE);
+	bf_log = log;
+}
+
+/* Start a new boot log at 'base', dropping what a previous boot left. */
+void bf_boot_log_start(uintptr_t base)
+{
+	struct bf_boot_log *log = (struct bf_boot_log *)base;
+
+	log->magic = BF_BOOT_LOG_MAGIC;
+	log->size = BF_BOOT_LOG_TEXT_SIZE;
+	log->reserved = 0;
+
+	bf_boot_log_unstage(log, 0, 0);
+}
+
+/* Carry on with the boot log the previous image started at 'base'. */
+void bf_boot_log_attach(uintptr_t base)
+{
+	struct bf_boot_log *log = (struct bf_boot_log *)base;
+
+	if (log->magic != BF_BOOT_LOG_MAGIC ||
+	    log->size != BF_BOOT_LOG_TEXT_SIZE) {
+		bf_boot_log_start(base);
+		return;
+	}
+
+	/* The header is read once; every store is bounded by our own size. */
+	bf_boot_log_unstage(log, log->head, log->lost);
+}
+
+/* Return the address of the DRAM boot log, or 0 if there is none yet. */
+uintptr_t bf_boot_log_base(void)
+{
+	return (uintptr_t)bf_log;
+}
+
+/*
+ * Called at the start of each log record. In BL2, send the records more
+ * verbose than BF_BOOT_LOG_CONSOLE_LEVEL to the boot log only, so they cost
+ * next to nothing, and give the other consoles back to any other record.
+ * BL31 is left alone as it doesn't know when the console state changes to
+ * runtime.
+ */
+void bf_boot_log_level(unsigned int log_level)
+{
+#ifdef IMAGE_BL2
+	int quiet = log_level > BF_BOOT_LOG_CONSOLE_LEVEL;
+
+	if (quiet != bf_log_quiet) {
+		bf_log_quiet = quiet;
+		console_switch_state(quiet ? BF_CONSOLE_FLAG_LOG_ONLY :
+				     CONSOLE_FLAG_BOOT);
+	}
+#endif
+}
+
+/*
+ * Called at the end of a record, which need not end the line: the other
+ * consoles get their output back from here on.
+ */
+void bf_boot_log_record_end(void)
+{
+#ifdef IMAGE_BL2
+	if (bf_log_quiet) {
+		bf_log_quiet = 0;
+		console_switch_state(CONSOLE_FLAG_BOOT);
+	}
+#endif
+}
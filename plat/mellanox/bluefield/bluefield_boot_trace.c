@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arch_helpers.h>
+#include <cassert.h>
+#include <debug.h>
+#include <mmio.h>
+#include <platform.h>
+#include "bluefield_boot_trace.h"
+
+/*
+ * The boot timestamp table lives in the shared RAM, which every BL image
+ * maps as device memory and which the DDR engines access with the MMU off,
+ * so records made from any core by BL2 are seen by BL31 without any cache
+ * maintenance. The timestamps are raw system counter values; as the counter
+ * starts at reset, the BL2 entry timestamp also accounts for BL1.
+ */
+#define BOOT_TS_MAGIC_ADDR	(BOOT_TS_BASE)
+#define BOOT_TS_ADDR(id)	(BOOT_TS_BASE + sizeof(uint64_t) * (1 + (id)))
+
+CASSERT(sizeof(struct bf_boot_ts) <= BOOT_TS_SIZE, assert_boot_ts_size);
+
+static const char * const bf_ts_stage_names[BF_TS_STAGE_NUM] = {
+	[BF_TS_BL2_ENTRY]		= "BL2 entry",
+	[BF_TS_SAM_DONE]		= "SAM setup done",
+	[BF_TS_HCA_AUTH_DONE]		= "HCA firmware auth done",
+	[BF_TS_MEM_START]		= "Memory setup start",
+	[BF_TS_MEM_DONE]		= "Memory setup done",
+	[BF_TS_PMR_DONE]		= "PMR setup done",
+	[BF_TS_TRIO_DONE]		= "TRIO setup done",
+	[BF_TS_NVDIMM_RESTORE_DONE]	= "NVDIMM restore done",
+	[BF_TS_BL31_ENTRY]		= "BL31 entry",
+	[BF_TS_BL31_PLAT_SETUP_DONE]	= "BL31 platform setup done",
+	[BF_TS_BL31_RUNTIME_SETUP]	= "BL31 runtime setup",
+};
+
+static int bf_boot_ts_valid(void)
+{
+	return mmio_read_64(BOOT_TS_MAGIC_ADDR) == BF_TS_MAGIC;
+}
+
+/*
+ * Clear the timestamp table and start a new trace. Only called once per
+ * boot, at BL2 entry; the shared RAM isn't zeroed on reset so the table
+ * left over from the previous boot must not be picked up.
+ */
+void bf_boot_ts_init(void)
+{
+	for (unsigned int id = 0; id < BF_TS_NUM; id++)
+		mmio_write_64(BOOT_TS_ADDR(id), 0);
+	mmio_write_64(BOOT_TS_MAGIC_ADDR, BF_TS_MAGIC);
+
+	bf_boot_ts_record(BF_TS_BL2_ENTRY);
+}
+
+/* Record the current system counter value as the timestamp of an event. */
+void bf_boot_ts_record(unsigned int id)
+{
+	if (id >= BF_TS_NUM || !bf_boot_ts_valid())
+		return;
+
+	mmio_write_64(BOOT_TS_ADDR(id), read_cntpct_el0());
+}
+
+/* Return the timestamp of an event, or 0 if it wasn't recorded. */
+uint64_t bf_boot_ts_get(unsigned int id)
+{
+	if (id >= BF_TS_NUM || !bf_boot_ts_valid())
+		return 0;
+
+	return mmio_read_64(BOOT_TS_ADDR(id));
+}
+
+static void bf_boot_ts_print_name(unsigned int id)
+{
+	if (id < BF_TS_IMAGE_BASE) {
+		tf_printf("%s", bf_ts_stage_names[id] ? bf_ts_stage_names[id] :
+			  "Unknown");
+	} else if (id < BF_TS_DDR_BASE) {
+		id -= BF_TS_IMAGE_BASE;
+		tf_printf("Image %u load %s", id / 2,
+			  (id & 1) ? "done" : "start");
+	} else {
+		id -= BF_TS_DDR_BASE;
+		if ((id % BF_TS_DDR_STEP_NUM) == 0)
+			tf_printf("MSS%u training start",
+				  id / BF_TS_DDR_STEP_NUM);
+		else if ((id % BF_TS_DDR_STEP_NUM) == BF_TS_DDR_STEP_DONE)
+			tf_printf("MSS%u training done",
+				  id / BF_TS_DDR_STEP_NUM);
+		else
+			tf_printf("MSS%u step %u", id / BF_TS_DDR_STEP_NUM,
+				  id % BF_TS_DDR_STEP_NUM);
+	}
+}
+
+/* Print all the recorded timestamps, in microseconds since reset. */
+void bf_boot_ts_dump(void)
+{
+	uint64_t freq = plat_get_syscnt_freq2();
+	uint64_t ts;
+
+	if (!bf_boot_ts_valid()) {
+		tf_printf("No boot timestamps recorded\n");
+		return;
+	}
+
+	for (unsigned int id = 0; id < BF_TS_NUM; id++) {
+		ts = mmio_read_64(BOOT_TS_ADDR(id));
+		if (ts == 0)
+			continue;
+		bf_boot_ts_print_name(id);
+		tf_printf(": %llu us\n", ts * 1000000 / freq);
+	}
+}
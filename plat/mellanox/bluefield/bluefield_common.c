@@ -41,6 +41,7 @@
 #include <platform.h>
 #include <platform_def.h>
 #include <xlat_tables.h>
+#include "bluefield_boot_log.h"
 #include "bluefield_def.h"
 #include "bluefield_private.h"
 #include "rsh_def.h"
@@ -161,6 +162,9 @@ void bluefield_console_init(void)
 {
 	uint32_t bf_console_baudrate = bluefield_get_baudrate();
 
+	/* The boot log console must be the last one in the list. */
+	bf_boot_log_register();
+
 	if (!console_pl011_register(BOOT_UART_BASE, BOOT_UART_CLK_IN_HZ,
 					bf_console_baudrate, &bf_console))
 		panic();
@@ -269,3 +273,23 @@ bl_params_t *plat_get_next_bl_params(void)
 	populate_next_bl_params_config(next_bl_params);
 	return next_bl_params;
 }
+
+static const char *prefix_str[] = {
+	"ERROR:   ", "NOTICE:  ", "WARNING: ", "INFO:    ", "VERBOSE: "};
+
+/*
+ * Same prefixes as the common implementation. This is also where the boot
+ * log and the tmfifo console learn the log level of each record.
+ */
+const char *plat_log_get_prefix(unsigned int log_level)
+{
+	if (log_level < LOG_LEVEL_ERROR)
+		log_level = LOG_LEVEL_ERROR;
+	else if (log_level > LOG_LEVEL_VERBOSE)
+		log_level = LOG_LEVEL_VERBOSE;
+
+	bf_boot_log_level(log_level);
+	console_tmfifo_log_level(log_level);
+
+	return prefix_str[(log_level / 10) - 1];
+}
@@ -39,6 +39,7 @@
 #include <pl011.h>
 #include <stdarg.h>
 #include <string.h>
+#include "bluefield_boot_trace.h"
 #include "bluefield_ddr.h"
 #include "rsh.h"
 
@@ -77,6 +78,7 @@ DECLARE_FUNC(list_func);
 DECLARE_FUNC(call_as);
 DECLARE_FUNC(sleep);
 DECLARE_FUNC(echo);
+DECLARE_FUNC(boottime);
 DECLARE_FUNC(repeat);
 DECLARE_FUNC(do_ato_probing);
 DECLARE_FUNC(do_dto_probing);
@@ -101,6 +103,7 @@ ADD_FUNC(list_func)
 ADD_FUNC(call_as)
 ADD_FUNC(sleep)
 ADD_FUNC(echo)
+ADD_FUNC(boottime)
 ADD_FUNC(repeat)
 ADD_FUNC(do_ato_probing)
 ADD_FUNC(do_dto_probing)
@@ -336,6 +339,14 @@ int echo(int argc, char * const argv[])
 	return 0;
 }
 
+/* Print the timestamps recorded so far during this boot. */
+int boottime(int argc, char * const argv[])
+{
+	bf_boot_ts_dump();
+
+	return 0;
+}
+
 int call_as(int argc, char * const argv[])
 {
 	int i;
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <mmio.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <pubsub_events.h>
+#include <spinlock.h>
+#include "bluefield_ddr_regs.h"
+#include "bluefield_ecc.h"
+#include "bluefield_private.h"
+#include "emi.h"
+
+/*
+ * Base addresses of the memory controllers, as in the device tables of
+ * bluefield_sam_data.c (only BL2 gets to see those).
+ */
+static const uintptr_t bf_ecc_mss_base[MAX_MEM_CTRL] = {
+	0x0018000000ULL,
+	0x0020000000ULL,
+};
+
+static struct bf_ecc_stats {
+	uint64_t ce_total;	/* As counted by the EMI. */
+	uint64_t ue_total;
+	uint32_t ce[MAX_RANKS_PER_MEM_CTRL][BF_ECC_BANKS];
+	uint32_t ue[MAX_RANKS_PER_MEM_CTRL][BF_ECC_BANKS];
+} bf_ecc_stats[MAX_MEM_CTRL];
+
+/*
+ * The ring is only written by bf_ecc_poll(), under bf_ecc_lock, and read
+ * without it: a record is published by bumping bf_ecc_head once it is
+ * written, and a reader checks the head again after copying it out, to
+ * tell whether the record was overwritten meanwhile.
+ */
+static struct bf_ecc_rec bf_ecc_ring[BF_ECC_RING_SIZE];
+static volatile uint64_t bf_ecc_head;
+
+static spinlock_t bf_ecc_lock;
+static uint32_t bf_ecc_mss_mask;
+
+/* Same as mem_config_read() in BL2, without the tracing. */
+static uint32_t bf_ecc_emi_read(uintptr_t base, uint32_t addr)
+{
+	return mmio_read_32(base + (1 << 22) + (EMI_BLOCK_ID << 14) +
+			    ((uintptr_t)addr << 2));
+}
+
+static void bf_ecc_emi_write(uintptr_t base, uint32_t addr, uint32_t data)
+{
+	mmio_write_32(base + (1 << 22) + (EMI_BLOCK_ID << 14) +
+		      ((uintptr_t)addr << 2), data);
+}
+
+/* Fetch and account the errors of one MSS; called with bf_ecc_lock held. */
+static void bf_ecc_poll_mss(unsigned int mss)
+{
+	uintptr_t base = bf_ecc_mss_base[mss];
+	struct bf_ecc_stats *s = &bf_ecc_stats[mss];
+	struct bf_ecc_rec *rec;
+	EMI_DRAM_ECC_COUNT_t cnt;
+	EMI_DRAM_ECC_ERROR_t cause;
+	EMI_DRAM_SYNDROM_t syn;
+	EMI_DRAM_ADDITIONAL_INFO_0_t info0;
+	EMI_DRAM_ADDITIONAL_INFO_1_t info1;
+
+	/* The counters clear on read. */
+	cnt.word = bf_ecc_emi_read(base, EMI_DRAM_ECC_COUNT);
+	cause.word = bf_ecc_emi_read(base, EMI_DRAM_ECC_ERROR);
+	if (!cnt.word && !cause.word)
+		return;
+
+	s->ce_total += cnt.single_error_count;
+	s->ue_total += cnt.double_error_count;
+
+	syn.word = bf_ecc_emi_read(base, EMI_DRAM_SYNDROM);
+	if (syn.serr || syn.derr) {
+		info0.word = bf_ecc_emi_read(base, EMI_DRAM_ADDITIONAL_INFO_0);
+		info1.word = bf_ecc_emi_read(base, EMI_DRAM_ADDITIONAL_INFO_1);
+
+		if (syn.derr)
+			s->ue[info0.err_prank][info0.err_bank]++;
+		else
+			s->ce[info0.err_prank][info0.err_bank]++;
+
+		rec = &bf_ecc_ring[bf_ecc_head % BF_ECC_RING_SIZE];
+		rec->ts = read_cntpct_el0();
+		rec->addr = ((uint64_t)bf_ecc_emi_read(base, EMI_DRAM_ERR_ADDR_1)
+			     << 32) | bf_ecc_emi_read(base, EMI_DRAM_ERR_ADDR_0);
+		rec->dram_addr = info1.err_addr;
+		rec->syndrome = syn.syndrom;
+		rec->mss = mss;
+		rec->prank = info0.err_prank;
+		rec->bank = info0.err_bank;
+		rec->derr = syn.derr;
+
+		/* Publish the record before moving on. */
+		dmbish();
+		bf_ecc_head++;
+
+		if (syn.derr)
+			WARN("MSS%u: uncorrectable ECC error at 0x%llx\n",
+			     mss, rec->addr);
+	}
+
+	/* Ack the interrupt cause, which lets the EMI latch the next error. */
+	bf_ecc_emi_write(base, EMI_DRAM_ECC_ERROR, cause.word);
+}
+
+void bf_ecc_poll(void)
+{
+	if (!bf_ecc_mss_mask)
+		return;
+
+	spin_lock(&bf_ecc_lock);
+	for (unsigned int mss = 0; mss < MAX_MEM_CTRL; mss++)
+		if (bf_ecc_mss_mask & (1 << mss))
+			bf_ecc_poll_mss(mss);
+	spin_unlock(&bf_ecc_lock);
+}
+
+/*
+ * Return the corrected and uncorrected error counts of a rank and bank of
+ * an MSS. BF_ECC_ALL for the bank sums up the banks of the rank, and for
+ * the rank returns the totals of the MSS, which also count the errors that
+ * came too close to one another to be latched.
+ */
+int bf_ecc_get_count(unsigned int mss, unsigned int prank, unsigned int bank,
+		     uint64_t *ce, uint64_t *ue)
+{
+	struct bf_ecc_stats *s;
+
+	if (mss >= MAX_MEM_CTRL || !(bf_ecc_mss_mask & (1 << mss)) ||
+	    (prank >= MAX_RANKS_PER_MEM_CTRL && prank != BF_ECC_ALL) ||
+	    (bank >= BF_ECC_BANKS && bank != BF_ECC_ALL))
+		return -1;
+
+	s = &bf_ecc_stats[mss];
+	*ce = *ue = 0;
+
+	spin_lock(&bf_ecc_lock);
+	if (prank == BF_ECC_ALL) {
+		*ce = s->ce_total;
+		*ue = s->ue_total;
+	} else {
+		for (unsigned int b = 0; b < BF_ECC_BANKS; b++) {
+			if (bank != BF_ECC_ALL && bank != b)
+				continue;
+			*ce += s->ce[prank][b];
+			*ue += s->ue[prank][b];
+		}
+	}
+	spin_unlock(&bf_ecc_lock);
+
+	return 0;
+}
+
+/*
+ * Copy out the record numbered *seq, or the oldest one still in the ring if
+ * it is gone, in which case *seq is updated. Returns -1 if there is no
+ * record with that number or a later one yet.
+ */
+int bf_ecc_get_rec(uint64_t *seq, struct bf_ecc_rec *rec)
+{
+	uint64_t head;
+
+	do {
+		head = bf_ecc_head;
+		if (*seq >= head)
+			return -1;
+		if (head - *seq >= BF_ECC_RING_SIZE)
+			*seq = head - (BF_ECC_RING_SIZE - 1);
+
+		dmbish();
+		*rec = bf_ecc_ring[*seq % BF_ECC_RING_SIZE];
+		dmbish();
+	} while (bf_ecc_head - *seq >= BF_ECC_RING_SIZE);
+
+	return 0;
+}
+
+#if BF_ECC_POLL_MS
+
+static uint64_t bf_ecc_period;
+
+/* The secure physical timer of the primary CPU paces the polling. */
+static void bf_ecc_timer_arm(void)
+{
+	u_register_t ctl = 0;
+
+	write_cntps_cval_el1(read_cntpct_el0() + bf_ecc_period);
+	set_cntp_ctl_enable(ctl);
+	write_cntps_ctl_el1(ctl);
+}
+
+static uint64_t bf_ecc_timer_handler(int irq, void *arg)
+{
+	bf_ecc_poll();
+	bf_ecc_timer_arm();
+
+	return 0;
+}
+
+/* The timer doesn't survive the primary CPU being powered down. */
+static void *bf_ecc_timer_restart(const void *arg)
+{
+	if (bf_ecc_mss_mask && plat_my_core_pos() == BF_PRIMARY_CPU)
+		bf_ecc_timer_arm();
+
+	return NULL;
+}
+SUBSCRIBE_TO_EVENT(psci_cpu_on_finish, bf_ecc_timer_restart);
+SUBSCRIBE_TO_EVENT(psci_suspend_pwrdown_finish, bf_ecc_timer_restart);
+
+#endif /* BF_ECC_POLL_MS */
+
+/* Called on the primary CPU once the interrupt handling is set up. */
+void bf_ecc_init(void)
+{
+	bf_ecc_mss_mask = bluefield_efi_mss_mask();
+	if (!bf_ecc_mss_mask) {
+		WARN("No memory controller to collect the ECC errors of\n");
+		return;
+	}
+
+	/* Drop whatever the boot time memory tests left behind. */
+	for (unsigned int mss = 0; mss < MAX_MEM_CTRL; mss++) {
+		uintptr_t base = bf_ecc_mss_base[mss];
+
+		if (!(bf_ecc_mss_mask & (1 << mss)))
+			continue;
+		bf_ecc_emi_read(base, EMI_DRAM_ECC_COUNT);
+		bf_ecc_emi_write(base, EMI_DRAM_ECC_ERROR,
+				 bf_ecc_emi_read(base, EMI_DRAM_ECC_ERROR));
+	}
+
+#if BF_ECC_POLL_MS
+	bf_ecc_period = plat_get_syscnt_freq2() * BF_ECC_POLL_MS / 1000;
+
+	if (bluefield_irq_register_pcpu(BF_PRIMARY_CPU, BF_IRQ_SEC_PHY_TIMER,
+					NULL, bf_ecc_timer_handler)) {
+		ERROR("ECC unable to register the timer irq handler.\n");
+		return;
+	}
+	bf_ecc_timer_arm();
+#endif
+}
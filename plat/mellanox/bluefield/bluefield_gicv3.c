@@ -36,8 +36,13 @@
 /* The GICv3 driver only needs to be initialized in EL3 */
 static uintptr_t rdistif_base_addrs[PLATFORM_CORE_COUNT];
 
+/* Secure interrupts are all handled at EL3 when using the EHF. */
 static const interrupt_prop_t bf_interrupt_props[] = {
+#if EL3_EXCEPTION_HANDLING
+	BF_G1S_IRQ_PROPS(INTR_GROUP0),
+#else
 	BF_G1S_IRQ_PROPS(INTR_GROUP1S),
+#endif
 	BF_G0_IRQ_PROPS(INTR_GROUP0)
 };
 
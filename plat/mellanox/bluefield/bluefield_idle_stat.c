@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arch_helpers.h>
+#include <platform.h>
+#include <platform_def.h>
+#include "bluefield_idle_stat.h"
+
+/*
+ * Per-CPU idle statistics. Each CPU only ever updates its own entry, with
+ * the data cache on, so no locking is needed; the histograms of one state
+ * fill a cache line each and the entries are cache line aligned so CPUs
+ * going in and out of idle don't bounce each other's lines.
+ */
+struct bf_idle_stat {
+	uint32_t entry[BF_IDLE_STAT_STATES][BF_IDLE_STAT_BUCKETS];
+	uint32_t exit[BF_IDLE_STAT_STATES][BF_IDLE_STAT_BUCKETS];
+	uint64_t enter_ts;		/* Entry into the platform code. */
+	unsigned int state;		/* Idle state being entered. */
+} __aligned(CACHE_WRITEBACK_GRANULE);
+
+static struct bf_idle_stat bf_idle_stats[PLATFORM_CORE_COUNT];
+
+/* Return the histogram bucket of a latency in system counter ticks. */
+static unsigned int bf_idle_stat_bucket(uint64_t ticks)
+{
+	uint64_t freq = plat_get_syscnt_freq2();
+	uint64_t ns;
+	unsigned int bucket;
+
+	/* Anything over a second goes in the last bucket anyway. */
+	if (ticks >= freq)
+		return BF_IDLE_STAT_BUCKETS - 1;
+
+	ns = ticks * 1000000000 / freq;
+	if (ns < (1 << BF_IDLE_STAT_MIN_SHIFT))
+		return 0;
+
+	bucket = 63 - __builtin_clzll(ns) - BF_IDLE_STAT_MIN_SHIFT + 1;
+
+	return bucket < BF_IDLE_STAT_BUCKETS ? bucket :
+		BF_IDLE_STAT_BUCKETS - 1;
+}
+
+/*
+ * Note that the calling CPU is about to enter the given idle state, or
+ * BF_IDLE_STAT_STATES for a state we don't keep statistics for. Called
+ * from the suspend and standby handlers, once PSCI has committed to the
+ * state.
+ */
+void bf_idle_stat_enter(unsigned int state)
+{
+	struct bf_idle_stat *stat = &bf_idle_stats[plat_my_core_pos()];
+
+	stat->state = state;
+	stat->enter_ts = read_cntpct_el0();
+}
+
+/*
+ * Account the idle period the calling CPU is coming back from, given the
+ * system counter values just before the wfi and right after the wake-up.
+ * Called as late as possible before going back to the normal world.
+ */
+void bf_idle_stat_record(uint64_t wfi_ts, uint64_t wake_ts)
+{
+	struct bf_idle_stat *stat = &bf_idle_stats[plat_my_core_pos()];
+	uint64_t now = read_cntpct_el0();
+
+	if (stat->state >= BF_IDLE_STAT_STATES)
+		return;
+
+	stat->entry[stat->state][bf_idle_stat_bucket(wfi_ts -
+						     stat->enter_ts)]++;
+	stat->exit[stat->state][bf_idle_stat_bucket(now - wake_ts)]++;
+}
+
+/* Read the entry and exit latency counts of one histogram bucket. */
+int bf_idle_stat_get(unsigned int cpu_idx, unsigned int state,
+		     unsigned int bucket, uint32_t *entry, uint32_t *exit)
+{
+	if (cpu_idx >= PLATFORM_CORE_COUNT || state >= BF_IDLE_STAT_STATES ||
+	    bucket >= BF_IDLE_STAT_BUCKETS)
+		return -1;
+
+	*entry = bf_idle_stats[cpu_idx].entry[state][bucket];
+	*exit = bf_idle_stats[cpu_idx].exit[state][bucket];
+
+	return 0;
+}
@@ -28,21 +28,45 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <ehf.h>
 #include <errno.h>
 #include <gicv3.h>
+#include <interrupt_mgmt.h>
 #include <platform.h>
 #include <platform_def.h>
-#include <interrupt_mgmt.h>
 #include <smcc_helpers.h>
-#include <debug.h>
+#include <spinlock.h>
+#include <utils_def.h>
 #include "bluefield_private.h"
 
-#define BLUEFIELD_IRQ_MAX	64
+/*
+ * Secure interrupts are dispatched through two byte-wide lookup tables
+ * indexed by interrupt ID: one shared by all CPUs for the SPIs and one per
+ * CPU for the SGIs and PPIs. Each entry is the index of the handler in
+ * irq_handlers[], 0 meaning that there is none, so a dispatch is two loads
+ * whatever the number of registered handlers.
+ */
+#define BLUEFIELD_IRQ_HANDLERS_MAX	32
 
 static struct irq_handler {
 	void *arg;
 	bluefield_irq_handler handler;
-} irq_tbl[BLUEFIELD_IRQ_MAX];
+} irq_handlers[BLUEFIELD_IRQ_HANDLERS_MAX];
+
+static uint8_t irq_spi_tbl[TOTAL_SPI_INTR_NUM];
+static uint8_t irq_private_tbl[PLATFORM_CORE_COUNT][TOTAL_PCPU_INTR_NUM];
+
+/* Per-CPU count of the interrupts we had nothing to do with. */
+static struct irq_stats {
+	uint32_t spurious;
+	uint32_t unhandled;
+} __aligned(CACHE_WRITEBACK_GRANULE) irq_stats[PLATFORM_CORE_COUNT];
+
+/* Serializes the (rare) updates of the tables. */
+static spinlock_t irq_tbl_lock;
 
 extern void gicd_set_isenabler(uintptr_t base, unsigned int id);
 extern void gicd_set_icenabler(uintptr_t base, unsigned int id);
@@ -55,41 +79,81 @@ void bluefield_irq_enable(unsigned int id, int enable)
 		gicd_set_icenabler(BASE_GICD_BASE, id);
 }
 
-static uint64_t irq_handler(uint32_t irq, uint32_t flags,
-			    void *handle, void *cookie)
+/*
+ * Call the handler registered for an acknowledged interrupt on this CPU.
+ * Returns -1 if the interrupt ID is a special one, which must not be
+ * EOIed; the caller must EOI the interrupt otherwise, handled or not.
+ */
+static int irq_dispatch(unsigned int irq)
 {
-	uint64_t ret = 0;
+	unsigned int cpu_idx = plat_my_core_pos();
+	struct irq_handler *h;
+	unsigned int idx;
 
-	/* Get the interrupt id of the signaled Group 1 interrupt. */
-	irq = read_icc_iar1_el1();
+	if (irq < TOTAL_PCPU_INTR_NUM) {
+		idx = irq_private_tbl[cpu_idx][irq];
+	} else if (irq <= MAX_SPI_ID) {
+		idx = irq_spi_tbl[irq - MIN_SPI_ID];
+	} else {
+		irq_stats[cpu_idx].spurious++;
+		return -1;
+	}
 
-	if (irq_tbl[irq].handler != NULL) {
-		ret = irq_tbl[irq].handler(irq, irq_tbl[irq].arg);
-		write_icc_eoir1_el1(irq);
+	h = &irq_handlers[idx];
+	if (idx == 0 || h->handler == NULL) {
+		irq_stats[cpu_idx].unhandled++;
+		VERBOSE("Unhandled secure interrupt %u\n", irq);
+		return 0;
 	}
 
-	return ret;
+	h->handler(irq, h->arg);
+
+	return 0;
 }
 
-int bluefield_irq_register(int irq, void *arg, bluefield_irq_handler handler)
+#if EL3_EXCEPTION_HANDLING
+
+/*
+ * Secure interrupts are Group 0 and handled at EL3 through the exception
+ * handling framework, which calls us for each of the priority levels below
+ * after acknowledging the interrupt. Nothing unmasks interrupts while a
+ * handler runs, so a high priority interrupt arriving meanwhile is taken
+ * once the current handler returns.
+ */
+static ehf_pri_desc_t bluefield_exceptions[] = {
+	EHF_PRI_DESC(BF_PRI_BITS, BF_IRQ_PRI_HIGH),
+	EHF_PRI_DESC(BF_PRI_BITS, BF_IRQ_PRI_NORMAL),
+};
+
+EHF_REGISTER_PRIORITIES(bluefield_exceptions,
+			ARRAY_SIZE(bluefield_exceptions), BF_PRI_BITS);
+
+static int irq_handler(uint32_t intr_raw, uint32_t flags,
+		       void *handle, void *cookie)
 {
-	if (irq >= BLUEFIELD_IRQ_MAX)
-		return -EINVAL;
-	if (irq_tbl[irq].handler != NULL)
-		return -EEXIST;
-	irq_tbl[irq].arg = arg;
-	dsb();
-	irq_tbl[irq].handler = handler;
+	if (irq_dispatch(plat_ic_get_interrupt_id(intr_raw)) == 0)
+		plat_ic_end_of_interrupt(intr_raw);
+
 	return 0;
 }
 
-int bluefield_irq_unregister(int irq, bluefield_irq_handler handler)
+void bluefield_irq_init(void)
 {
-	if (irq >= BLUEFIELD_IRQ_MAX)
-		return -EINVAL;
-	if (irq_tbl[irq].handler != handler)
-		return -EEXIST;
-	irq_tbl[irq].handler = NULL;
+	ehf_register_priority_handler(BF_IRQ_PRI_HIGH, irq_handler);
+	ehf_register_priority_handler(BF_IRQ_PRI_NORMAL, irq_handler);
+}
+
+#else
+
+static uint64_t irq_handler(uint32_t irq, uint32_t flags,
+			    void *handle, void *cookie)
+{
+	/* Get the interrupt id of the signaled Group 1 interrupt. */
+	irq = read_icc_iar1_el1();
+
+	if (irq_dispatch(irq) == 0)
+		write_icc_eoir1_el1(irq);
+
 	return 0;
 }
 
@@ -105,3 +169,152 @@ void bluefield_irq_init(void)
 	if (rc)
 		panic();
 }
+
+#endif /* EL3_EXCEPTION_HANDLING */
+
+/* Find the slot of a handler, allocating one if asked to. */
+static unsigned int irq_handler_slot(void *arg, bluefield_irq_handler handler,
+				     int alloc)
+{
+	unsigned int free = 0;
+
+	for (unsigned int i = 1; i < BLUEFIELD_IRQ_HANDLERS_MAX; i++) {
+		if (irq_handlers[i].handler == handler &&
+		    irq_handlers[i].arg == arg)
+			return i;
+		if (irq_handlers[i].handler == NULL && free == 0)
+			free = i;
+	}
+
+	if (!alloc || free == 0)
+		return 0;
+
+	irq_handlers[free].arg = arg;
+	irq_handlers[free].handler = handler;
+
+	return free;
+}
+
+/* Drop the slot of a handler once no table entry refers to it anymore. */
+static void irq_handler_put(unsigned int idx)
+{
+	for (unsigned int i = 0; i < TOTAL_SPI_INTR_NUM; i++)
+		if (irq_spi_tbl[i] == idx)
+			return;
+	for (unsigned int cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++)
+		for (unsigned int i = 0; i < TOTAL_PCPU_INTR_NUM; i++)
+			if (irq_private_tbl[cpu][i] == idx)
+				return;
+
+	irq_handlers[idx].handler = NULL;
+}
+
+/*
+ * Point the table entries of an interrupt to a handler slot. For an SGI or
+ * a PPI, only the entry of the given CPU is set, or the ones of all the
+ * CPUs if cpu_idx is negative.
+ */
+static int irq_set(int cpu_idx, int irq, unsigned int idx,
+		   unsigned int expected)
+{
+	unsigned int first = 0, last = PLATFORM_CORE_COUNT - 1;
+
+	if (irq >= MIN_SPI_ID) {
+		if (irq_spi_tbl[irq - MIN_SPI_ID] != expected)
+			return -EEXIST;
+		irq_spi_tbl[irq - MIN_SPI_ID] = idx;
+		return 0;
+	}
+
+	if (cpu_idx >= 0)
+		first = last = cpu_idx;
+
+	for (unsigned int cpu = first; cpu <= last; cpu++)
+		if (irq_private_tbl[cpu][irq] != expected)
+			return -EEXIST;
+	for (unsigned int cpu = first; cpu <= last; cpu++)
+		irq_private_tbl[cpu][irq] = idx;
+
+	return 0;
+}
+
+/*
+ * Register the handler of a secure interrupt. SGIs and PPIs may have a
+ * different handler on each CPU: cpu_idx selects the CPU the handler is
+ * registered for, or all of them if negative. It is ignored for SPIs.
+ */
+int bluefield_irq_register_pcpu(int cpu_idx, int irq, void *arg,
+				bluefield_irq_handler handler)
+{
+	unsigned int idx;
+	int rc;
+
+	if (irq < 0 || irq > MAX_SPI_ID || cpu_idx >= PLATFORM_CORE_COUNT ||
+	    handler == NULL)
+		return -EINVAL;
+
+	spin_lock(&irq_tbl_lock);
+
+	idx = irq_handler_slot(arg, handler, 1);
+	if (idx == 0) {
+		spin_unlock(&irq_tbl_lock);
+		return -ENOMEM;
+	}
+
+	/* Make sure the slot is seen before any CPU can dispatch to it. */
+	dsb();
+
+	rc = irq_set(cpu_idx, irq, idx, 0);
+	if (rc)
+		irq_handler_put(idx);
+
+	spin_unlock(&irq_tbl_lock);
+
+	return rc;
+}
+
+int bluefield_irq_unregister_pcpu(int cpu_idx, int irq,
+				  bluefield_irq_handler handler)
+{
+	unsigned int idx = 0;
+	int rc = -EEXIST;
+
+	if (irq < 0 || irq > MAX_SPI_ID || cpu_idx >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	spin_lock(&irq_tbl_lock);
+
+	if (irq >= MIN_SPI_ID)
+		idx = irq_spi_tbl[irq - MIN_SPI_ID];
+	else
+		idx = irq_private_tbl[cpu_idx < 0 ? 0 : cpu_idx][irq];
+
+	if (idx != 0 && irq_handlers[idx].handler == handler) {
+		rc = irq_set(cpu_idx, irq, 0, idx);
+		irq_handler_put(idx);
+	}
+
+	spin_unlock(&irq_tbl_lock);
+
+	return rc;
+}
+
+int bluefield_irq_register(int irq, void *arg, bluefield_irq_handler handler)
+{
+	return bluefield_irq_register_pcpu(-1, irq, arg, handler);
+}
+
+int bluefield_irq_unregister(int irq, bluefield_irq_handler handler)
+{
+	return bluefield_irq_unregister_pcpu(-1, irq, handler);
+}
+
+/* Return the spurious and unhandled secure interrupt counts of a CPU. */
+void bluefield_irq_get_stats(unsigned int cpu_idx, uint32_t *spurious,
+			     uint32_t *unhandled)
+{
+	assert(cpu_idx < PLATFORM_CORE_COUNT);
+
+	*spurious = irq_stats[cpu_idx].spurious;
+	*unhandled = irq_stats[cpu_idx].unhandled;
+}
@@ -36,7 +36,11 @@
 #include <mmio.h>
 #include <platform.h>
 #include <psci.h>
+#include <pubsub_events.h>
+#include <spinlock.h>
+#include <utils_def.h>
 #include "bluefield_def.h"
+#include "bluefield_idle_stat.h"
 #include "bluefield_private.h"
 #include "bluefield_system.h"
 #include "platform_def.h"
@@ -88,23 +92,91 @@ const unsigned int bluefield_pm_idle_states[] = {
 	0,
 };
 
+CASSERT(ARRAY_SIZE(bluefield_pm_idle_states) == BF_IDLE_STAT_STATES + 1,
+	assert_idle_stat_states);
+
 /* Global flag indicating if the call to power down the CPU is for suspend. */
 static int is_suspend;
 
+/* Layout of one per-CPU release slot; must match the MBOX_SLOT_* offsets. */
+struct bf_mbox_slot {
+	volatile uintptr_t entry;
+	volatile uint64_t release_gen;
+	volatile uint64_t park_gen;
+	volatile uint64_t wfi_ts;	/* Last suspend, for idle stats. */
+	volatile uint64_t wake_ts;
+	uint64_t reserved[3];
+};
+
+CASSERT(sizeof(struct bf_mbox_slot) == MBOX_SLOT_SIZE, assert_mbox_slot_size);
+CASSERT(MBOX_SLOT_BASE + PLATFORM_CORE_COUNT * MBOX_SLOT_SIZE <= BOOT_TS_BASE,
+	assert_mbox_slots_fit);
+
+#define bf_mbox_slot(cpu_idx) \
+	((struct bf_mbox_slot *)(uintptr_t)(MBOX_SLOT_BASE +	\
+					    (cpu_idx) * MBOX_SLOT_SIZE))
+
+/*
+ * Return the index in bluefield_pm_idle_states of the idle state matching
+ * the given target state, or BF_IDLE_STAT_STATES if there is none.
+ */
+static unsigned int bluefield_idle_state_index(
+				const psci_power_state_t *target_state)
+{
+	unsigned int state_id;
+	int i, lvl;
+
+	for (i = 0; !!bluefield_pm_idle_states[i]; i++) {
+		state_id = psci_get_pstate_id(bluefield_pm_idle_states[i]);
+
+		for (lvl = MPIDR_AFFLVL0; lvl <= PLAT_MAX_PWR_LVL; lvl++) {
+			if (target_state->pwr_domain_state[lvl] !=
+			    (state_id & BF_LOCAL_PSTATE_MASK))
+				break;
+			state_id >>= BF_LOCAL_PSTATE_WIDTH;
+		}
+
+		if (lvl > PLAT_MAX_PWR_LVL)
+			return i;
+	}
+
+	return BF_IDLE_STAT_STATES;
+}
+
+/* Warm boot entry point handed to us by PSCI. */
+static uintptr_t bf_sec_entrypoint;
+
+/*
+ * Serializes the first release of CPUs out of the BL1 holding pen, as the
+ * legacy CPU bitmap is shared by all of them. Later releases only touch the
+ * target's own slot and don't need it.
+ */
+static spinlock_t bf_cpu_bitmap_lock;
+
 /*******************************************************************************
  * BlueField handler called when a CPU is about to enter standby.
  ******************************************************************************/
 void bluefield_cpu_standby(plat_local_state_t cpu_state)
 {
+	psci_power_state_t target_state = { { 0 } };
+	uint64_t wfi_ts, wake_ts;
 
 	assert(cpu_state == BF_LOCAL_STATE_RET);
 
+	target_state.pwr_domain_state[BF_PWR_LVL0] = cpu_state;
+	bf_idle_stat_enter(bluefield_idle_state_index(&target_state));
+
 	/*
 	 * Enter standby state
 	 * dsb is good practice before using wfi to enter low power states
 	 */
+	wfi_ts = read_cntpct_el0();
 	dsb();
 	wfi();
+	wake_ts = read_cntpct_el0();
+
+	/* Only a few instructions are left until we return to the caller. */
+	bf_idle_stat_record(wfi_ts, wake_ts);
 }
 
 /*******************************************************************************
@@ -117,15 +189,37 @@ int bluefield_pwr_domain_on(u_register_t mpidr)
 	int cpu_idx = plat_core_pos_by_mpidr(mpidr);
 	uintptr_t *mailbox = (void *) MBOX_BASE;
 	uint64_t *cpu_bitmap = (uint64_t *)&mailbox[1];
+	uint64_t cpu_bit = 1ULL << (cpu_idx & 0x3F);
+	struct bf_mbox_slot *slot = bf_mbox_slot(cpu_idx);
 
-	/* Set the target CPU's bit in the bitmap. */
-	cpu_bitmap[cpu_idx >> 6] |= (1ULL << (cpu_idx & 0x3F));
+	/*
+	 * Publish the entry point before the new generation. PSCI makes sure
+	 * only one cpu_on at a time targets this CPU, and the CPU itself is
+	 * parked, so we are the only writer of the release side of the slot.
+	 */
+	slot->entry = bf_sec_entrypoint;
+	dmbsy();
+	slot->release_gen = slot->park_gen + 1;
+	flush_dcache_range((uintptr_t) slot, sizeof(*slot));
 
-	/* Make sure everyone can see the bitmap. */
-	flush_dcache_range((uintptr_t) &cpu_bitmap[cpu_idx >> 6],
-			   sizeof(*cpu_bitmap));
+	/*
+	 * A CPU which has never been started is still in the BL1 holding
+	 * pen, which only looks at the legacy bitmap. Bits are never cleared
+	 * again once set, so the unlocked check is safe.
+	 */
+	if ((cpu_bitmap[cpu_idx >> 6] & cpu_bit) == 0) {
+		spin_lock(&bf_cpu_bitmap_lock);
+		cpu_bitmap[cpu_idx >> 6] |= cpu_bit;
+		flush_dcache_range((uintptr_t) &cpu_bitmap[cpu_idx >> 6],
+				   sizeof(*cpu_bitmap));
+		spin_unlock(&bf_cpu_bitmap_lock);
+	}
 
-	/* Wake up anyone waiting. */
+	/*
+	 * Wake up anyone waiting. Parked CPUs run with the MMU and caches off
+	 * so they can't be woken through the exclusive monitor; the others
+	 * just recheck their own slot and go back to sleep.
+	 */
 	dsbsy();
 	sev();
 
@@ -140,8 +234,7 @@ void bluefield_pwr_domain_off(const psci_power_state_t *target_state)
 {
 	int cpu_idx;
 	u_register_t mpidr;
-	uintptr_t *mailbox = (void *) MBOX_BASE;
-	uint64_t *cpu_bitmap = (uint64_t *)&mailbox[1];
+	struct bf_mbox_slot *slot;
 	assert(target_state->pwr_domain_state[BF_PWR_LVL0] ==
 					BF_LOCAL_STATE_OFF);
 
@@ -159,12 +252,15 @@ void bluefield_pwr_domain_off(const psci_power_state_t *target_state)
 	/* Get the mpidr for this cpu */
 	mpidr = read_mpidr_el1();
 	cpu_idx = plat_core_pos_by_mpidr(mpidr);
-	/* Clear the target CPU's bit in the bitmap. */
-	cpu_bitmap[cpu_idx >> 6] &= ~(1ULL << (cpu_idx & 0x3F));
+	slot = bf_mbox_slot(cpu_idx);
 
-	/* Make sure everyone can see the bitmap. */
-	flush_dcache_range((uintptr_t) &cpu_bitmap[cpu_idx >> 6],
-			   sizeof(*cpu_bitmap));
+	/*
+	 * Consume the release we were started with. This has to be visible
+	 * before PSCI marks us off, as a cpu_on may be issued right after.
+	 */
+	slot->park_gen = slot->release_gen;
+	flush_dcache_range((uintptr_t) slot, sizeof(*slot));
+	dsbsy();
 }
 
 /*******************************************************************************
@@ -177,8 +273,7 @@ void __dead2 bluefield_pwr_domain_pwr_down_wfi(const psci_power_state_t *target)
 	int cpu_idx;
 	u_register_t mpidr;
 	uint32_t sctlr;
-	uintptr_t *mailbox = (void *) MBOX_BASE;
-	uint64_t *cpu_bitmap = (uint64_t *)&mailbox[1];
+	struct bf_mbox_slot *slot;
 
 	/*
 	 * Turn off address translation. When the core boots up again
@@ -195,19 +290,25 @@ void __dead2 bluefield_pwr_domain_pwr_down_wfi(const psci_power_state_t *target)
 	/* Get the mpidr for this cpu */
 	mpidr = read_mpidr_el1();
 	cpu_idx = plat_core_pos_by_mpidr(mpidr);
+	slot = bf_mbox_slot(cpu_idx);
 
 	if (!is_suspend) {
 		/* Wait until we are released again. */
-		while((cpu_bitmap[cpu_idx >> 6] &
-		       (1ULL << (cpu_idx & 0x3F))) == 0)
+		while (slot->release_gen == slot->park_gen)
 			wfe();
+		dmbsy();
 	} else {
-		/* Wait for a interrupt to unsuspend */
+		/*
+		 * Wait for a interrupt to unsuspend. The idle statistics
+		 * timestamps go to our slot, as our data cache is off.
+		 */
+		slot->wfi_ts = read_cntpct_el0();
 		wfi();
+		slot->wake_ts = read_cntpct_el0();
 	}
 
-	/* Get address of entrypoint from mailbox and jump to it. */
-	(*((void (**)(void))MBOX_BASE))();
+	/* Get address of entrypoint from our slot and jump to it. */
+	((void (*)(void))slot->entry)();
 
 	/* We shouldn't ever return. */
 	panic();
@@ -329,6 +430,8 @@ int bluefield_validate_ns_entrypoint(uintptr_t entrypoint)
  ******************************************************************************/
 void bluefield_pwr_domain_suspend(const psci_power_state_t *target_state)
 {
+	bf_idle_stat_enter(bluefield_idle_state_index(target_state));
+
 	/* Tell bluefield_pwr_domain_pwr_down_wfi that the CPU is suspending. */
 	is_suspend = 1;
 }
@@ -343,6 +446,23 @@ void bluefield_pwr_domain_suspend_finish(const psci_power_state_t *target_state)
 	is_suspend = 0;
 }
 
+#ifdef BF_IDLE_STAT
+/*
+ * Account a power down suspend once PSCI is done with it, right before we
+ * go back to the normal world with the data cache on again.
+ */
+static void *bluefield_idle_stat_pwrdown_finish(const void *arg)
+{
+	struct bf_mbox_slot *slot = bf_mbox_slot(plat_my_core_pos());
+
+	bf_idle_stat_record(slot->wfi_ts, slot->wake_ts);
+
+	return NULL;
+}
+SUBSCRIBE_TO_EVENT(psci_suspend_pwrdown_finish,
+		   bluefield_idle_stat_pwrdown_finish);
+#endif
+
 void bluefield_get_sys_suspend_power_state(psci_power_state_t *req_state)
 {
 	for (int i = MPIDR_AFFLVL0; i <= PLAT_MAX_PWR_LVL; i++)
@@ -376,12 +496,24 @@ int plat_setup_psci_ops(uintptr_t sec_entrypoint,
 {
 	uintptr_t *mailbox;
 	uint64_t *cpu_bitmap;
+	struct bf_mbox_slot *slot;
 
 	*psci_ops = &bluefield_plat_psci_ops;
 
 	/* Program the jump address. */
 	mailbox = (void *) MBOX_BASE;
 	*mailbox = sec_entrypoint;
+	bf_sec_entrypoint = sec_entrypoint;
+
+	/* Nobody has been parked by us yet; start all slots out idle. */
+	for (int i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		slot = bf_mbox_slot(i);
+		slot->entry = sec_entrypoint;
+		slot->release_gen = 0;
+		slot->park_gen = 0;
+	}
+	flush_dcache_range(MBOX_SLOT_BASE,
+			   PLATFORM_CORE_COUNT * MBOX_SLOT_SIZE);
 
 	/*
 	 * Zero out the CPU bitmap. This is big enough for 128 CPUs; once
@@ -28,13 +28,21 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <bluefield_boot_trace.h>
+#include <bluefield_ecc.h>
+#include <bluefield_idle_stat.h>
 #include <bluefield_svc.h>
+#include <cassert.h>
 #include <mmio.h>
+#include <platform.h>
+#include <platform_def.h>
 #include <rsh.h>
 #include <runtime_svc.h>
 #include <spinlock.h>
 #include <swap_boot.h>
 #include <uuid.h>
+#include <xlat_tables.h>
+#include "bluefield_private.h"
 
 static spinlock_t breadcrumb_lock;
 
@@ -112,7 +120,20 @@ static uintptr_t set_second_reset_action(void *handle,
 	SMC_RET1(handle, 0);
 }
 
-static uintptr_t get_second_reset_action(void *handle)
+static u_register_t get_post_reset_wdog(void)
+{
+	return mmio_read_64(RSHIM_BASE + RSH_BREADCRUMB0) &
+		BREADCRUMB_WDOG_MASK;
+}
+
+static u_register_t get_reset_action(void)
+{
+	return (mmio_read_64(RSHIM_BASE + RSH_BOOT_CONTROL) >>
+		RSH_BOOT_CONTROL__BOOT_MODE_SHIFT) &
+		RSH_BOOT_CONTROL__BOOT_MODE_MASK;
+}
+
+static u_register_t get_second_reset_action(void)
 {
 	uint64_t breadcrumb = mmio_read_64(RSHIM_BASE + RSH_BREADCRUMB0);
 	u_register_t result;
@@ -123,10 +144,10 @@ static uintptr_t get_second_reset_action(void *handle)
 	else
 		result = MLNX_BOOT_NONE;
 
-	SMC_RET1(handle, result);
+	return result;
 }
 
-static uintptr_t get_tbb_fuse_status(void *handle, u_register_t fuse_status)
+static u_register_t get_tbb_fuse_status(u_register_t fuse_status)
 {
 	RSH_SB_KEY_VLD_t key_vld;
 	uint64_t sb_mode;
@@ -159,7 +180,148 @@ static uintptr_t get_tbb_fuse_status(void *handle, u_register_t fuse_status)
 		result = SMCCC_INVALID_PARAMETERS;
 	}
 
-	SMC_RET1(handle, result);
+	return result;
+}
+
+/*
+ * Check that a normal world buffer lies in the part of the DRAM we have
+ * mapped; as for the NVDIMM code, that is the next to last mmap entry.
+ */
+static int ns_buf_valid(uintptr_t base, size_t size)
+{
+	const mmap_region_t *map = bluefield_get_mmap() +
+		PLAT_MMAP_ENTRIES - 2;
+
+	if (base + size < base)
+		return 0;
+
+	return base >= map->base_va && base + size <= map->base_va + map->size;
+}
+
+/* Run one query of a batch; returns 0 or an SMC error code. */
+static int batch_query(struct mlnx_batch_entry *e)
+{
+	uint32_t fid = e->fid;
+	uint64_t arg = e->arg;
+	u_register_t value;
+
+	switch (fid) {
+	case MLNX_GET_POST_RESET_WDOG:
+		value = get_post_reset_wdog();
+		break;
+	case MLNX_GET_RESET_ACTION:
+		value = get_reset_action();
+		break;
+	case MLNX_GET_SECOND_RESET_ACTION:
+		value = get_second_reset_action();
+		break;
+	case MLNX_GET_TBB_FUSE_STATUS:
+		value = get_tbb_fuse_status(arg);
+		if (value == SMCCC_INVALID_PARAMETERS)
+			return SMCCC_INVALID_PARAMETERS;
+		break;
+	case MLNX_GET_BOOT_TIMESTAMP:
+		if (arg >= BF_TS_NUM)
+			return SMCCC_INVALID_PARAMETERS;
+		value = bf_boot_ts_get(arg);
+		break;
+	default:
+		return SMC_UNK;
+	}
+
+	e->value = value;
+
+	return 0;
+}
+
+/*
+ * Run a batch of queries from a normal world buffer. The header is read
+ * once, so the normal world changing it under our feet can't make us go
+ * past the buffer.
+ */
+static uintptr_t get_batch(void *handle, u_register_t base, u_register_t size)
+{
+	struct mlnx_batch_hdr *hdr = (struct mlnx_batch_hdr *)base;
+	struct mlnx_batch_entry *e;
+	uint32_t count;
+
+	if (size < sizeof(*hdr) || size > MLNX_BATCH_MAX_SIZE ||
+	    (base & (sizeof(uint64_t) - 1)) || !ns_buf_valid(base, size))
+		SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+
+	count = hdr->count;
+	if (hdr->version != MLNX_BATCH_VERSION ||
+	    count > (size - sizeof(*hdr)) / sizeof(*e))
+		SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+
+	e = (struct mlnx_batch_entry *)(hdr + 1);
+	for (uint32_t i = 0; i < count; i++, e++)
+		e->status = batch_query(e);
+
+	SMC_RET1(handle, count);
+}
+
+static uintptr_t get_idle_latency(void *handle, u_register_t mpidr,
+				  u_register_t state, u_register_t bucket)
+{
+	int cpu_idx = plat_core_pos_by_mpidr(mpidr);
+	uint32_t entry, exit;
+
+	if (cpu_idx < 0 || state >= BF_IDLE_STAT_STATES ||
+	    bucket >= BF_IDLE_STAT_BUCKETS ||
+	    bf_idle_stat_get(cpu_idx, state, bucket, &entry, &exit))
+		SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+
+	SMC_RET2(handle, entry, exit);
+}
+
+CASSERT(MLNX_ECC_ALL == BF_ECC_ALL, assert_mlnx_ecc_all_matches);
+
+static uintptr_t get_ecc_count(void *handle, u_register_t mss,
+			       u_register_t prank, u_register_t bank)
+{
+	uint64_t ce, ue;
+
+	bf_ecc_poll();
+
+	if (mss > UINT32_MAX || prank > UINT32_MAX || bank > UINT32_MAX ||
+	    bf_ecc_get_count(mss, prank, bank, &ce, &ue))
+		SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+
+	SMC_RET2(handle, ce, ue);
+}
+
+static uintptr_t get_ecc_record(void *handle, u_register_t seq)
+{
+	struct bf_ecc_rec rec;
+	uint64_t n = seq;
+
+	bf_ecc_poll();
+
+	if (bf_ecc_get_rec(&n, &rec))
+		SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+
+	SMC_RET4(handle, n, rec.addr,
+		 ((uint64_t)rec.mss << MLNX_ECC_REC_MSS_SHIFT) |
+		 ((uint64_t)rec.prank << MLNX_ECC_REC_PRANK_SHIFT) |
+		 ((uint64_t)rec.bank << MLNX_ECC_REC_BANK_SHIFT) |
+		 ((uint64_t)rec.derr << MLNX_ECC_REC_DERR_SHIFT) |
+		 ((uint64_t)rec.syndrome << MLNX_ECC_REC_SYNDROME_SHIFT) |
+		 ((uint64_t)rec.dram_addr << MLNX_ECC_REC_DRAM_ADDR_SHIFT),
+		 rec.ts);
+}
+
+static uintptr_t get_irq_stats(void *handle, u_register_t mpidr)
+{
+	int cpu_idx = plat_core_pos_by_mpidr(mpidr);
+	uint32_t spurious, unhandled;
+
+	if (cpu_idx < 0)
+		SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+
+	bluefield_irq_get_stats(cpu_idx, &spurious, &unhandled);
+
+	SMC_RET2(handle, spurious, unhandled);
 }
 
 static uintptr_t bluefield_smc_handler(uint32_t smc_fid, u_register_t x1,
@@ -173,27 +335,42 @@ static uintptr_t bluefield_smc_handler(uint32_t smc_fid, u_register_t x1,
 		return set_post_reset_wdog(handle, x1);
 
 	case MLNX_GET_POST_RESET_WDOG:
-		SMC_RET1(handle,
-			 (mmio_read_64(RSHIM_BASE + RSH_BREADCRUMB0) &
-			  BREADCRUMB_WDOG_MASK));
+		SMC_RET1(handle, get_post_reset_wdog());
 
 	case MLNX_SET_RESET_ACTION:
 		return set_reset_action(handle, x1);
 
 	case MLNX_GET_RESET_ACTION:
-		SMC_RET1(handle,
-			 ((mmio_read_64(RSHIM_BASE + RSH_BOOT_CONTROL) >>
-			   RSH_BOOT_CONTROL__BOOT_MODE_SHIFT) &
-			  RSH_BOOT_CONTROL__BOOT_MODE_MASK));
+		SMC_RET1(handle, get_reset_action());
 
 	case MLNX_SET_SECOND_RESET_ACTION:
 		return set_second_reset_action(handle, x1);
 
 	case MLNX_GET_SECOND_RESET_ACTION:
-		return get_second_reset_action(handle);
+		SMC_RET1(handle, get_second_reset_action());
 
 	case MLNX_GET_TBB_FUSE_STATUS:
-		return get_tbb_fuse_status(handle, x1);
+		SMC_RET1(handle, get_tbb_fuse_status(x1));
+
+	case MLNX_GET_BOOT_TIMESTAMP:
+		if (x1 >= BF_TS_NUM)
+			SMC_RET1(handle, SMCCC_INVALID_PARAMETERS);
+		SMC_RET1(handle, bf_boot_ts_get(x1));
+
+	case MLNX_GET_IDLE_LATENCY:
+		return get_idle_latency(handle, x1, x2, x3);
+
+	case MLNX_GET_BATCH:
+		return get_batch(handle, x1, x2);
+
+	case MLNX_GET_ECC_COUNT:
+		return get_ecc_count(handle, x1, x2, x3);
+
+	case MLNX_GET_ECC_RECORD:
+		return get_ecc_record(handle, x1);
+
+	case MLNX_GET_IRQ_STATS:
+		return get_irq_stats(handle, x1);
 
 	case MLNX_SIP_SVC_CALL_COUNT:
 		/* Return the number of Mellanox SiP Service Calls */
@@ -51,6 +51,14 @@
 
 #define DEBUG_LEVEL_MAX		11
 
+/*
+ * The BIST can take up to 105s to finish if we are in random scan mode for 4
+ * rank RDIMMs with total capacity of 64GB. So we wait 2 mintues for a run.
+ * This might needs to be bumped up further when we test LRDIMMs with total
+ * capacity of more than 64GB.
+ */
+#define BIST_RUN_TIMEOUT_MS	120000
+
 #ifdef ATF_CONSOLE
   #define ADD_GLOBAL_VAR(name, default_val) int name = default_val;
 #else
@@ -146,6 +154,7 @@ static uint64_t bist_random(void)
  */
 static uint32_t get_high_addr(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t density_dev, data_width, num_banks;
 	uint32_t high_address;
 
@@ -182,6 +191,8 @@ static uint32_t get_high_addr(void)
  */
 static int check_rnd_scan_support(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/*
 	 * Due to a bug, random mode is not supported for x16/x8 DIMMs with 2Gb
 	 * components (14 bits of row address).
@@ -211,6 +222,7 @@ static int check_rnd_scan_support(void)
  */
 static uint32_t get_rnd_bits(int *cnt_offset_addr)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	const int package_x4_rowbits_lut[NUM_DENSITY] = {
 		[DENSITY_2Gbit] = 15,	[DENSITY_4Gbit] = 16,
 		[DENSITY_8Gbit] = 17,	[DENSITY_16Gbit] = 18,
@@ -384,10 +396,10 @@ static void print_bytes(uint8_t *bytes, int len, int brac_cnt, int *brac_idx)
 	tf_printf("\n");
 }
 
+#ifdef ATF_CONSOLE
 static void print_bist_parameters(const struct bist_parameters *bist_params,
 				  int show_run_specific_params, int pattern)
 {
-#ifdef ATF_CONSOLE
 	tf_printf("\n-------------------------------------------\n");
 	tf_printf(" BIST Parameters:\n");
 	if (show_run_specific_params) {
@@ -419,8 +431,8 @@ static void print_bist_parameters(const struct bist_parameters *bist_params,
 
 	}
 	tf_printf("\n-------------------------------------------\n");
-#endif /* ATF_CONSOLE */
 }
+#endif /* ATF_CONSOLE */
 
 /*
  * Print out the exact error on the error bit.
@@ -512,13 +524,59 @@ static void print_dq_state_string(uint32_t bit_place, uint32_t expected_bit)
 
 }
 
-static void print_error_info(uint32_t abs_mc)
+/*
+ * Read the data of the first error of the previous BIST run on the current
+ * MSS along with the data expected there, and find which bytes of the
+ * pattern line differ once masked with the DQMASK of the given pattern.
+ * Return the number of such bytes, whose indexes are put in error_idx.
+ */
+static int get_error_data(uint32_t abs_mc, uint32_t pattern,
+			  uint8_t *error_data, uint8_t *expected_data,
+			  uint32_t *byte_start, uint32_t *pat_length,
+			  int *error_idx)
+{
+	int error_cnt = 0;
+	uint32_t *data;
+	EMC_IFC_BIST_STATUS_t ifc_bist_status;
+
+	ifc_bist_status.word = emc_read(EMC_IFC_BIST_STATUS);
+
+	/*
+	 * Figure out where the error occurred and read the expected and error
+	 * data there.
+	 */
+	data = (uint32_t *)error_data;
+	for (int i = 0; i < EMC_IFC_BIST_ERR_DATA__LENGTH; i++)
+		data[i] = emc_read(EMC_IFC_BIST_ERR_DATA__FIRST_WORD + i);
+
+	read_emem_mc_sram_line((uint32_t *)&expected_data[0],
+				ifc_bist_status.err_sram_entry_0);
+	read_emem_mc_sram_line((uint32_t *)&expected_data[36],
+				ifc_bist_status.err_sram_entry_1);
+
+	*byte_start = ifc_bist_status.err_chunk * PATTERN_LINE_LENGTH;
+
+	*pat_length = MIN((unsigned int)PATTERN_LINE_LENGTH,
+			  bist_configs[pattern].pattern_length);
+
+	/* Find the index of the data which are different. */
+	for (int i = 0; i < *pat_length; i++) {
+		uint8_t dq_mask = ifc_bist_mask[abs_mc][pattern][i];
+
+		if ((expected_data[*byte_start + i] & dq_mask) !=
+		    (error_data[*byte_start + i] & dq_mask))
+			error_idx[error_cnt++] = i;
+	}
+
+	return error_cnt;
+}
+
+static void print_error_info(uint32_t abs_mc, uint32_t pattern)
 {
 	uint32_t byte_start;
 	uint32_t pat_length;
 	int error_idx[PATTERN_LINE_LENGTH];
-	int error_cnt = 0;
-	uint32_t *data;
+	int error_cnt;
 
 	uint8_t error_data[MAX_BIST_BLOCK_SIZE] = {0};
 	uint8_t expected_data[MAX_BIST_BLOCK_SIZE] = {0};
@@ -553,32 +611,8 @@ static void print_error_info(uint32_t abs_mc)
 					ifc_bist_status.err_sram_entry_1);
 	}
 
-	/*
-	 * Figure out where the error occurred and read the expected and error
-	 * data there.
-	 */
-	data = (uint32_t *)error_data;
-	for (int i = 0; i < EMC_IFC_BIST_ERR_DATA__LENGTH; i++)
-		data[i] = emc_read(EMC_IFC_BIST_ERR_DATA__FIRST_WORD + i);
-
-	read_emem_mc_sram_line((uint32_t *)&expected_data[0],
-				ifc_bist_status.err_sram_entry_0);
-	read_emem_mc_sram_line((uint32_t *)&expected_data[36],
-				ifc_bist_status.err_sram_entry_1);
-
-	byte_start = ifc_bist_status.err_chunk * PATTERN_LINE_LENGTH;
-
-	pat_length = MIN((unsigned int)PATTERN_LINE_LENGTH,
-			 bist_configs[bist_current_patt].pattern_length);
-
-	/* Find the index of the data which are different. */
-	for (int i = 0; i < pat_length; i++) {
-		uint8_t dq_mask = ifc_bist_mask[abs_mc][bist_current_patt][i];
-
-		if ((expected_data[byte_start + i] & dq_mask) !=
-		    (error_data[byte_start + i] & dq_mask))
-			error_idx[error_cnt++] = i;
-	}
+	error_cnt = get_error_data(abs_mc, pattern, error_data, expected_data,
+				   &byte_start, &pat_length, error_idx);
 
 	/*
 	 * Print out the expected data and the error data bytes, highlighting
@@ -597,7 +631,7 @@ static void print_error_info(uint32_t abs_mc)
 		int byte_idx = error_idx[i] + byte_start;
 
 		uint8_t dq_mask =
-			 ifc_bist_mask[abs_mc][bist_current_patt][error_idx[i]];
+			 ifc_bist_mask[abs_mc][pattern][error_idx[i]];
 
 		exp_ch = expected_data[byte_idx] & dq_mask;
 		err_ch = error_data[byte_idx] & dq_mask;
@@ -775,6 +809,7 @@ static int set_bist_pattern(struct bist_parameters *params)
  */
 static void configure_bist(struct bist_parameters *params, uint32_t pattern)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t base_address;
 	uint32_t high_address;
 
@@ -819,6 +854,7 @@ static void configure_bist(struct bist_parameters *params, uint32_t pattern)
 			continue;
 		if (!ddr_switch_current_mss(abs_mc))
 			continue;
+		dp = ddr_cur_dp();
 
 		dbg_printf(3, "configure_bist start for mss: %d mc_mask=%d\n",
 			   abs_mc, params->mc_mask);
@@ -937,6 +973,7 @@ static void execute_bist(struct bist_parameters *params)
 	}
 }
 
+#ifdef ATF_CONSOLE
 /*
  * Get the result of the previous BIST run.
  * Return 0 if the BIST was successful or the corresponding bit
@@ -973,7 +1010,7 @@ static int get_bist_results(uint32_t mc_mask, int print_info)
 			status |= 1 << abs_mc;
 			loop_results[bist_current_patt][abs_mc]++;
 			if (g_debug_level > 0)
-				print_error_info(abs_mc);
+				print_error_info(abs_mc, bist_current_patt);
 		}
 	}
 
@@ -985,13 +1022,7 @@ static int get_bist_results(uint32_t mc_mask, int print_info)
  */
 static int stop_bist(uint32_t mc_mask, uint32_t print_info)
 {
-	/*
-	 * The BIST can take up to 105s to finish if we are in random scan mode
-	 * for 4 rank RDIMMs with total capacity of 64GB. So we wait 2 mintues
-	 * here. This might needs to be bumped up further when we test LRDIMMs
-	 * with total capacity of more than 64GB.
-	 */
-	const unsigned int timeout_ms = 120000;
+	const unsigned int timeout_ms = BIST_RUN_TIMEOUT_MS;
 	unsigned int ms;
 	EMC_IFC_BIST_STATUS_t bist_status;
 	EMC_IFC_BIST_EN_t bist_en;
@@ -1069,6 +1100,314 @@ static int start_bist(struct bist_parameters *params, uint32_t pattern,
 
 	return status;
 }
+#endif /* ATF_CONSOLE */
+
+/*
+ * Add one to the count of each DQ/CB line on which the first error of the
+ * previous BIST run on the current MSS was seen. dq_errors is indexed by
+ * the DQ number, followed by the CB number at DQ_NUM.
+ */
+static void count_error_dqs(uint32_t abs_mc, uint32_t pattern,
+			    uint32_t dq_errors[DATA_QUEUES])
+{
+	uint32_t byte_start;
+	uint32_t pat_length;
+	int error_idx[PATTERN_LINE_LENGTH];
+	int error_cnt;
+	uint8_t seen[DATA_QUEUES] = {0};
+
+	uint8_t error_data[MAX_BIST_BLOCK_SIZE] = {0};
+	uint8_t expected_data[MAX_BIST_BLOCK_SIZE] = {0};
+
+	error_cnt = get_error_data(abs_mc, pattern, error_data, expected_data,
+				   &byte_start, &pat_length, error_idx);
+
+	for (int i = 0; i < error_cnt; i++) {
+		int byte_idx = error_idx[i] + byte_start;
+		uint8_t diff = (expected_data[byte_idx] ^ error_data[byte_idx]) &
+			       ifc_bist_mask[abs_mc][pattern][error_idx[i]];
+
+		for (int bit_idx = 0; bit_idx < 8; bit_idx++) {
+			uint32_t bit;
+			int dq;
+
+			if (!(diff & (1 << bit_idx)))
+				continue;
+
+			bit = (8 * byte_idx + bit_idx) %
+			      BYTES_TO_BITS(PATTERN_LINE_LENGTH);
+			dq = BF_BIST_IS_CB(bit) ? DQ_NUM + BF_BIST_GET_CB(bit) :
+						  BF_BIST_GET_DQ(bit);
+			if (!seen[dq]++)
+				dq_errors[dq]++;
+		}
+	}
+}
+
+/****************************************************************************/
+/* BIST scheduler.                                                          */
+/****************************************************************************/
+/*
+ * The BIST engines of the memory controllers are independent, so rather
+ * than running each BIST on all the MSSes in lock step the scheduler lets
+ * every MSS go through its own list of runs: as soon as one MSS finishes a
+ * run its results are collected and its next run (the next section of
+ * adjacent ranks, the next iteration or the next pattern, whose SRAM lines
+ * get written right then) is launched, while the other MSSes keep going.
+ */
+
+/* Per MSS state of the scheduler. */
+struct bist_sched_mc {
+	/* Parameters of the current run. */
+	struct bist_parameters	params;
+	/* Index of the current pattern in the list of patterns. */
+	int			patt_idx;
+	/* Iterations of the current pattern left after the current one. */
+	uint32_t		iters_left;
+	/* Ranks left to run the current iteration on. */
+	uint32_t		ranks_left;
+	/* How long the current run has been going on, in ms. */
+	unsigned int		ms;
+	/* Set while a run is going on. */
+	int			running;
+};
+
+/* Failing DQ/CB line counts of the last scheduler run, per MSS. */
+static uint32_t bist_dq_errors[MAX_MEM_CTRL][DATA_QUEUES];
+
+/*
+ * Launch the next run on the given MSS. Return 1 if launched, 0 if the MSS
+ * is done with its list or -1 if the pattern could not be set.
+ */
+static int bist_sched_launch(struct bist_sched_mc *s, int abs_mc,
+			     uint32_t pr_mask, const int *patterns,
+			     int patt_num, uint32_t iterations)
+{
+	int pattern;
+	int start, ranks;
+	uint32_t bist_ranks;
+
+	while (s->ranks_left == 0) {
+		if (s->iters_left > 0) {
+			s->iters_left--;
+		} else {
+			if (++s->patt_idx >= patt_num)
+				return 0;
+
+			pattern = patterns[s->patt_idx];
+#ifdef ATF_CONSOLE
+			fill_pattern(pattern);
+#endif
+			s->params = bist_configs[pattern];
+			s->params.mc_mask = 1 << abs_mc;
+			if (!set_bist_pattern(&s->params)) {
+				ERROR("set_bist_pattern failed\n");
+				return -1;
+			}
+			s->iters_left = iterations - 1;
+		}
+		s->ranks_left = pr_mask;
+	}
+
+	/* BIST can only be run on adjacent ranks at a time. */
+	start = __builtin_ctz(s->ranks_left);
+	ranks = __builtin_ctz(~(s->ranks_left >> start));
+	bist_ranks = ((1 << ranks) - 1) << start;
+	s->ranks_left &= ~bist_ranks;
+
+	pattern = patterns[s->patt_idx];
+	s->params.mc_mask = 1 << abs_mc;
+	memset(s->params.mc_pr_mask, 0, sizeof(s->params.mc_pr_mask));
+	s->params.mc_pr_mask[abs_mc] = bist_ranks;
+
+	dbg_printf(3, "bist_sched MSS%d pattern %d ranks 0x%x\n", abs_mc,
+		   pattern, bist_ranks);
+
+	configure_bist(&s->params, pattern);
+	/* The random scan mode might not be supported on this MSS. */
+	if (s->params.mc_mask == 0) {
+		s->ranks_left = 0;
+		s->iters_left = 0;
+		return bist_sched_launch(s, abs_mc, pr_mask, patterns,
+					 patt_num, iterations);
+	}
+	execute_bist(&s->params);
+
+	/* Disable BIST, the single run carries on until its end of test. */
+	emc_write(EMC_IFC_BIST_EN, 0);
+
+	s->ms = 0;
+	s->running = 1;
+
+	return 1;
+}
+
+/* Print the failing DQ/CB line counts of the last scheduler run. */
+static void print_bist_dq_errors(uint32_t mc_mask)
+{
+	for (int abs_mc = 0; abs_mc < MAX_MEM_CTRL; abs_mc++) {
+		if (!(mc_mask & (1 << abs_mc)))
+			continue;
+
+		tf_printf("  Memory Device: %d failing lines:", abs_mc);
+		for (int dq = 0; dq < DATA_QUEUES; dq++) {
+			if (bist_dq_errors[abs_mc][dq] == 0)
+				continue;
+			if (dq < DQ_NUM)
+				tf_printf(" DQ%d", dq);
+			else
+				tf_printf(" CB%d", dq - DQ_NUM);
+			tf_printf("(%u)", bist_dq_errors[abs_mc][dq]);
+		}
+		tf_printf("\n");
+	}
+}
+
+/*
+ * Give up on a scheduler run: let the runs still going on reach their end
+ * of test, then hand every MSS which has run a BIST back to the memory
+ * controller. There is no way to abort a BIST run, so an MSS whose run
+ * does not end in time is handed back anyway.
+ */
+static void bist_sched_stop(struct bist_sched_mc *sched, uint32_t mc_mask)
+{
+	EMC_IFC_BIST_STATUS_t bist_status;
+
+	for (int abs_mc = 0; abs_mc < MAX_MEM_CTRL; abs_mc++) {
+		struct bist_sched_mc *s = &sched[abs_mc];
+
+		if (!s->running || !ddr_switch_current_mss(abs_mc))
+			continue;
+
+		for (; s->ms < BIST_RUN_TIMEOUT_MS; s->ms++) {
+			bist_status.word = emc_read(EMC_IFC_BIST_STATUS);
+			if (bist_status.end_of_test == 1)
+				break;
+			mdelay(1);
+		}
+		if (s->ms >= BIST_RUN_TIMEOUT_MS)
+			ERROR("Unable to stop bist at MSS %d\n", abs_mc);
+		s->running = 0;
+	}
+
+	enable_emem_mc_hw(mc_mask);
+}
+
+/*
+ * Run each of the patt_num BIST patterns in the patterns list iterations
+ * times on the ranks of mc_pr_mask of each memory controller in mc_mask.
+ * The failures are counted per pattern and MSS in loop_results and per DQ/CB
+ * line in bist_dq_errors.
+ * Return 0 if all the runs passed, -1 if a run couldn't be completed or the
+ * bitmask of the memory controllers on which some run failed. The memory
+ * controllers are back in normal operation on return, whatever the result.
+ */
+static int run_bist_sched(uint32_t mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL],
+			  const int *patterns, int patt_num,
+			  uint32_t iterations, int print_info)
+{
+	struct bist_sched_mc sched[MAX_MEM_CTRL];
+	EMC_IFC_BIST_STATUS_t bist_status;
+	int status = 0;
+	int running = 0;
+	int pattern;
+	int ret;
+
+	if (patt_num == 0 || iterations == 0)
+		return 0;
+
+	memset(sched, 0, sizeof(sched));
+	memset(loop_results, 0, sizeof(loop_results));
+	memset(bist_dq_errors, 0, sizeof(bist_dq_errors));
+
+	for (int abs_mc = 0; abs_mc < MAX_MEM_CTRL; abs_mc++) {
+		sched[abs_mc].patt_idx = -1;
+
+		if (!(mc_mask & (1 << abs_mc)) || mc_pr_mask[abs_mc] == 0)
+			continue;
+		if (!ddr_switch_current_mss(abs_mc))
+			continue;
+
+		ret = bist_sched_launch(&sched[abs_mc], abs_mc,
+					mc_pr_mask[abs_mc], patterns,
+					patt_num, iterations);
+		if (ret < 0) {
+			bist_sched_stop(sched, mc_mask);
+			return -1;
+		}
+		running += ret;
+	}
+
+	while (running > 0) {
+		mdelay(1);
+
+		if (ctrlc()) {
+			tf_printf("BIST interrupted\n");
+			bist_sched_stop(sched, mc_mask);
+			return -1;
+		}
+
+		for (int abs_mc = 0; abs_mc < MAX_MEM_CTRL; abs_mc++) {
+			struct bist_sched_mc *s = &sched[abs_mc];
+
+			if (!s->running || !ddr_switch_current_mss(abs_mc))
+				continue;
+
+			bist_status.word = emc_read(EMC_IFC_BIST_STATUS);
+			if (bist_status.end_of_test != 1) {
+				if (++s->ms >= BIST_RUN_TIMEOUT_MS) {
+					ERROR("Unable to stop bist at MSS %d\n",
+					      abs_mc);
+					s->running = 0;
+					bist_sched_stop(sched, mc_mask);
+					return -1;
+				}
+				continue;
+			}
+
+			s->running = 0;
+			running--;
+
+			pattern = patterns[s->patt_idx];
+			if (s->params.op_mode != WRITE_ONLY &&
+			    emc_read(EMC_IFC_BIST_ERR_CNTR) > 0) {
+				status |= 1 << abs_mc;
+				loop_results[pattern][abs_mc]++;
+				count_error_dqs(abs_mc, pattern,
+						bist_dq_errors[abs_mc]);
+				if (g_debug_level > 0) {
+					tf_printf("  Memory Device: %d BIST "
+						  "Failed\n", abs_mc);
+					print_error_info(abs_mc, pattern);
+				}
+			}
+
+			enable_emem_mc_hw(1 << abs_mc);
+
+			ret = bist_sched_launch(s, abs_mc, mc_pr_mask[abs_mc],
+						patterns, patt_num, iterations);
+			if (ret < 0) {
+				bist_sched_stop(sched, mc_mask);
+				return -1;
+			}
+			running += ret;
+		}
+	}
+
+	if (print_info) {
+		for (int abs_mc = 0; abs_mc < MAX_MEM_CTRL; abs_mc++) {
+			if (!(mc_mask & (1 << abs_mc)))
+				continue;
+			tf_printf("  Memory Device: %d BIST %s\n", abs_mc,
+				  (status & (1 << abs_mc)) ? "Failed" :
+							     "Passed");
+		}
+	}
+	if (status != 0 && g_debug_level > 0)
+		print_bist_dq_errors(status);
+
+	return status;
+}
 
 #ifdef ATF_CONSOLE
 /****************************************************************************/
@@ -1212,36 +1551,20 @@ static void bist_loop_rand(uint32_t mc_mask, int mc_pr_mask[MAX_MEM_CTRL],
 static int bist_loop(uint32_t mc_mask, int mc_pr_mask[MAX_MEM_CTRL],
 		     uint32_t iterations)
 {
-	struct bist_parameters params;
-
-	params.mc_mask = mc_mask;
-	params.mc_pr_mask[0] = mc_pr_mask[0];
-	params.mc_pr_mask[1] = mc_pr_mask[1];
-
-	memset(loop_results, 0x0, sizeof(loop_results));
-
-	for (int config = 0; config < RANDOM_PATTERN; config++) {
-		tf_printf("current config=%d\n", config);
-
-		params = bist_configs[config];
-		params.mc_mask = mc_mask;
-		params.mc_pr_mask[0] = mc_pr_mask[0];
-		params.mc_pr_mask[1] = mc_pr_mask[1];
-
-		tf_printf("setting bist pattern\n");
-		if (!set_bist_pattern(&params)) {
-			tf_printf("set_bist_pattern failed\n");
-			return -1;
-		}
-		for (int bist = 0; bist < iterations; bist++) {
-			tf_printf("bist iteration %d\n", bist);
-
-			if (ctrlc())
-				break;
+	int patterns[RANDOM_PATTERN];
+	uint32_t pr_mask[MAX_MEM_CTRL];
+	int status;
+
+	for (int config = 0; config < RANDOM_PATTERN; config++)
+		patterns[config] = config;
+	for (int mc = 0; mc < MAX_MEM_CTRL; mc++)
+		pr_mask[mc] = mc_pr_mask[mc];
+
+	status = run_bist_sched(mc_mask, pr_mask, patterns, RANDOM_PATTERN,
+				iterations, 0);
+	if (status < 0)
+		return -1;
 
-			start_bist(&params, config, 0);
-		}
-	}
 	tf_printf("\n\t");
 
 	/* Print out the BIST results. */
@@ -1260,6 +1583,8 @@ static int bist_loop(uint32_t mc_mask, int mc_pr_mask[MAX_MEM_CTRL],
 		}
 		tf_printf("\n");
 	}
+	if (status != 0)
+		print_bist_dq_errors(status);
 
 	return 0;
 }
@@ -2053,66 +2378,9 @@ int ddr_bist(int argc, char *const argv[])
 int run_standalone_bist(uint32_t mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL],
 			int pattern)
 {
-	uint32_t status = 0;
-	int one_run = 1;
-	struct bist_parameters bist_params;
-
 	INFO("run_standalone_bist skip_mc=0x%x\n", mc_mask);
-	bist_params = bist_configs[pattern];
-	bist_params.mc_mask = mc_mask;
-	/*
-	 * set_bist_pattern() just writes the BIST pattern to the memory
-	 * controller's SRAM, thus it doesn't care which ranks are specified.
-	 */
-	if (!set_bist_pattern(&bist_params)) {
-		ERROR("set_bist_pattern failed\n");
-		return -1;
-	}
-	/*
-	 * Check that if we can run BIST on all the ranks at once, as BIST can
-	 * only be run on adjacent ranks at a time.
-	 */
-	for (int i = 0; i < MAX_MEM_CTRL; i++)
-		if (popcount(mc_pr_mask[i]) + __builtin_ctz(mc_pr_mask[i]) +
-		    __builtin_clz(mc_pr_mask[i]) != sizeof(mc_pr_mask[i]) * 8) {
-			one_run = 0;
-			break;
-		}
-
-	if (one_run) {
-		for (int i = 0; i < MAX_MEM_CTRL; i++)
-			bist_params.mc_pr_mask[i] = mc_pr_mask[i];
-
-		status = start_bist(&bist_params, pattern, 0);
-
-		return status;
-	}
-	/*
-	 * If we can't run the BIST in one run, we start it in sections of the
-	 * rank that the BIST can handle.
-	 */
-	for (int i = 0; i < MAX_MEM_CTRL; i++) {
-		if (!(mc_mask & (1 << i)))
-			continue;
 
-		uint32_t ranks_left = mc_pr_mask[i];
-
-		bist_params.mc_mask = 1 << i;
-		memset(bist_params.mc_pr_mask, 0,
-		       sizeof(bist_params.mc_pr_mask));
-
-		while (ranks_left) {
-			int start = __builtin_ctz(ranks_left);
-			int ranks = __builtin_ctz((~(ranks_left >> start)));
-			uint32_t bist_ranks = ((1 << ranks) - 1) << start;
-
-			ranks_left &= ~bist_ranks;
-			bist_params.mc_pr_mask[i] = bist_ranks;
-			status |= start_bist(&bist_params, pattern, 0);
-		}
-	}
-
-	return status;
+	return run_bist_sched(mc_mask, mc_pr_mask, &pattern, 1, 1, 0);
 }
 /*
  * The BIST we should do regularly when booting up system to ensure that the
@@ -2133,3 +2401,20 @@ int init_ddr_by_bist(uint32_t mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL])
 	return run_standalone_bist(mc_mask, mc_pr_mask, INIT_00_PATTERN);
 }
 
+/*
+ * The BIST done at boot: the default BIST, unless skip_default is set, then
+ * zeroing out all the memory. Each MSS goes on to zeroing out its memory as
+ * soon as its own default BIST is done.
+ * Return 0 if it finished successfully or non-zero if it failed.
+ */
+int post_ddr_bist(uint32_t mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL],
+		  int skip_default)
+{
+	static const int patterns[] = { KILLER_PATTERN, INIT_00_PATTERN };
+
+	if (skip_default)
+		return init_ddr_by_bist(mc_mask, mc_pr_mask);
+
+	return run_bist_sched(mc_mask, mc_pr_mask, patterns,
+			      ARRAYSIZE(patterns), 1, 0);
+}
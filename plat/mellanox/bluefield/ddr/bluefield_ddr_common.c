@@ -35,6 +35,8 @@
 #include <mmio.h>
 #include <string.h>
 #include "bluefield_ddr.h"
+#include "bluefield_ddr_shadow.h"
+#include "bluefield_ddr_stats.h"
 #include "emc.h"
 #include "emi.h"
 #include "pub.h"
@@ -49,6 +51,7 @@ int ddr_log_flag = LOG_MEM_TRANSACTION;
 
 void mem_config_ndelay(uint32_t wait)
 {
+	ddr_stats_delay(wait);
 	ndelay(wait);
 }
 
@@ -72,6 +75,7 @@ void mem_config_write(uintptr_t base, uint32_t id, uint32_t addr,
 
 	PCI_DUMP("%5d         %c %11.3x %10.3x %15.8x\n", 1, 'W',
 		 id, addr, data);
+	ddr_stats_mmio(1);
 	mmio_write_32(reg_addr, data);
 }
 
@@ -82,6 +86,7 @@ uint32_t mem_config_read(uintptr_t base, uint32_t id, uint32_t addr)
 			     ((uintptr_t)addr << 2);
 	uint32_t data = mmio_read_32(reg_addr);
 
+	ddr_stats_mmio(0);
 	PCI_DUMP("%5d         %c %11.3x %10.3x %15.8x\n", 1, 'R',
 		 id, addr, data);
 	return data;
@@ -99,6 +104,7 @@ uint32_t mem_config_read(uintptr_t base, uint32_t id, uint32_t addr)
  * read_val	If not null, the place to write the final read value.
  * Returns 1 if the read value matches the given exp_val, else returns 0 if
  * timed out and the value still doesn't matches.
+ * The register is always read from HW, never from the register shadow.
  */
 int read_loop(uint32_t (*read_func)(uint32_t), uint32_t reg_id, uint32_t mask,
 	      uint32_t exp_val, uint32_t delay_max, uint32_t delay_intvl,
@@ -108,15 +114,26 @@ int read_loop(uint32_t (*read_func)(uint32_t), uint32_t reg_id, uint32_t mask,
 		reg_id, mask, exp_val);
 
 	uint32_t delay = 0;
-	uint32_t data = read_func(reg_id);
+	uint32_t retries = 0;
+	uint32_t data;
+
+	ddr_shadow_bypass(1);
+	data = read_func(reg_id);
 
 	while (((data ^ exp_val) & mask) != 0 ) {
-		if (delay_max && delay >= delay_max)
+		if (delay_max && delay >= delay_max) {
+			ddr_shadow_bypass(0);
+			ddr_stats_poll(retries);
 			return 0;
+		}
 		mem_config_ndelay(delay_intvl);
 		delay += delay_intvl;
+		retries++;
 		data = read_func(reg_id);
 	}
+	ddr_shadow_bypass(0);
+	ddr_stats_poll(retries);
+
 	if (read_val != NULL)
 		*read_val = data;
 	return 1;
@@ -145,16 +162,22 @@ static const char *get_reg_name(int reg_type, int reg_id)
 
 void emc_write(uint32_t reg_id, uint32_t data)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 #ifdef ATF_CONSOLE
 	if (ddr_reg_flag)
 		printf("SET EMC_%s = 0x%.8x\n",
 			get_reg_name(EMC_REG, reg_id), data);
 #endif
+	if (ddr_shadow_write(EMC_REG, reg_id, data))
+		return;
+
 	mem_config_write(dp->mss_addr, EMC_BLOCK_ID, reg_id, data);
 }
 
 uint32_t emc_read(uint32_t reg_id)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t data;
 
 	data = mem_config_read(dp->mss_addr, EMC_BLOCK_ID, reg_id);
@@ -170,6 +193,8 @@ uint32_t emc_read(uint32_t reg_id)
 
 void emi_write(uint32_t reg_id, uint32_t data)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/*
 	 * The SPARE register was used as a last minute ECO fix, and since it
 	 * was not RTL synthesis there were some limitations and we need to put
@@ -186,12 +211,15 @@ void emi_write(uint32_t reg_id, uint32_t data)
 		printf("SET EMI_%s = 0x%.8x\n",
 			get_reg_name(EMI_REG, reg_id), data);
 #endif
+	if (ddr_shadow_write(EMI_REG, reg_id, data))
+		return;
 
 	mem_config_write(dp->mss_addr, EMI_BLOCK_ID, reg_id, data);
 }
 
 uint32_t emi_read(uint32_t reg_id)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t data;
 
 	data = mem_config_read(dp->mss_addr, EMI_BLOCK_ID, reg_id);
@@ -218,6 +246,7 @@ uint32_t emi_read(uint32_t reg_id)
 static int pub_access(uint32_t reg_id, uint32_t *data,
 		      uint32_t mem_id, uint32_t op)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	EMC_IND_CMD_t cmd = {
 		.mem_id = mem_id,
 		.op = op,
@@ -227,7 +256,11 @@ static int pub_access(uint32_t reg_id, uint32_t *data,
 		emc_write(EMC_IND_DATA__FIRST_WORD, *data);
 
 	emc_write(EMC_IND_ADDR, reg_id);
-	emc_write(EMC_IND_CMD, cmd.word);
+	/*
+	 * Issue the command directly rather than with emc_write(), which
+	 * would take it for a PHY operation and invalidate the shadow.
+	 */
+	mem_config_write(dp->mss_addr, EMC_BLOCK_ID, EMC_IND_CMD, cmd.word);
 
 	EMC_IND_STS_t sts = {
 		.rdy = 1,
@@ -254,9 +287,13 @@ void pub_write(uint32_t reg_id, uint32_t data)
 			get_reg_name(PUB_REG, reg_id), data);
 	ddr_reg_flag = 0;
 #endif
-	if (!pub_access(reg_id, &data, EMC_IND_CMD__MEM_ID_VAL_APB,
-			EMC_IND_CMD__OP_VAL_WRITE))
+	ddr_stats_pub(1);
+	if (!ddr_shadow_write(PUB_REG, reg_id, data) &&
+	    !pub_access(reg_id, &data, EMC_IND_CMD__MEM_ID_VAL_APB,
+			EMC_IND_CMD__OP_VAL_WRITE)) {
 		MEM_ERR("PUB write with reg_id=0x%x failed.\n", reg_id);
+		ddr_shadow_invalidate();
+	}
 #ifdef ATF_CONSOLE
 	ddr_reg_flag = reg_flag;
 #endif
@@ -273,7 +310,9 @@ uint32_t pub_read(uint32_t reg_id)
 	ddr_reg_flag = 0;
 #endif
 
-	if (!pub_access(reg_id, &data, EMC_IND_CMD__MEM_ID_VAL_APB,
+	ddr_stats_pub(0);
+	if (!ddr_shadow_read(PUB_REG, reg_id, &data) &&
+	    !pub_access(reg_id, &data, EMC_IND_CMD__MEM_ID_VAL_APB,
 			EMC_IND_CMD__OP_VAL_READ))
 		MEM_ERR("PUB read with reg_id=0x%x failed.\n", reg_id);
 
@@ -298,6 +337,8 @@ void pub_indirect_write(uint32_t reg_id, uint32_t data)
 			get_reg_name(PUB_INDIRECT_REG, reg_id), data);
 	ddr_reg_flag = 0;
 #endif
+	ddr_stats_pub(1);
+	ddr_shadow_write(PUB_INDIRECT_REG, reg_id, data);
 	if (!pub_access(reg_id, &data, EMC_IND_CMD__MEM_ID_VAL_PHY,
 			EMC_IND_CMD__OP_VAL_WRITE))
 		MEM_ERR("PUB indirect write with reg_id=0x%x failed.\n",
@@ -318,6 +359,7 @@ uint32_t pub_indirect_read(uint32_t reg_id)
 	ddr_reg_flag = 0;
 #endif
 
+	ddr_stats_pub(0);
 	if (!pub_access(reg_id, &data, EMC_IND_CMD__MEM_ID_VAL_PHY,
 			EMC_IND_CMD__OP_VAL_READ))
 		MEM_ERR("PUB indirect read with reg_id=0x%x failed.\n", reg_id);
@@ -355,6 +397,8 @@ int direct_addr_host_op(uint32_t op_cmd, uint32_t op_ecc_en,
 			uint32_t op_bg, uint32_t op_ba,
 			uint32_t op_col, uint32_t op_row)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/* Before executing, first check the parameters are valid. */
 	if ((op_cmd != DIRECT_ADDR_HOST_OP__READ &&
 	     op_cmd != DIRECT_ADDR_HOST_OP__WRITE) ||
@@ -474,7 +518,7 @@ void pub_switch_rankidr(unsigned int rank_num, int is_write, int is_read)
 int ddr_switch_current_mss(int mss_index)
 {
 	if (mss_index < MAX_MEM_CTRL && dps[mss_index].dimm_num) {
-		dp = &(dps[mss_index]);
+		ddr_set_cur_dp(&(dps[mss_index]));
 		return 1;
 	}
 	ERROR("MSS%d not present.\n", mss_index);
@@ -544,9 +588,13 @@ int pir_cmd(uint32_t pir_val, uint32_t timeout, const char *operation,
 	if (!read_loop(pub_read, PUB_PGSR0, pgsr0.word, pgsr0.word,
 		       timeout, MAX(1u, timeout / 100), &pgsr0_val)) {
 		MEM_ERR("%s timed out.\n", operation);
+		ddr_shadow_invalidate();
 		return 0;
 	}
 
+	/* The training steps have updated the PHY registers. */
+	ddr_shadow_invalidate();
+
 	if (((pgsr0_val & pgsr0_done) == pgsr0_done) &&
 	     (pgsr0_val & pgsr0_err) == 0) {
 		MEM_VERB("%s finished!\n", operation);
@@ -595,8 +643,10 @@ int ddr_phy_scheduler_single_op(uint32_t schcr0, uint32_t schcr1)
 	if (!read_loop(pub_read, PUB_SCHCR0, schcr0_msk.word, schcr0_exp.word,
 		       1 * NS_PER_US, 10, NULL)) {
 		MEM_ERR("Timed out waiting for schcr0.schtrig == 0\n");
+		ddr_shadow_invalidate();
 		return 0;
 	}
+	ddr_shadow_invalidate();
 	SET_MEM_REG_FIELD(pub, PUB_PGCR1, pubmode, 0x0);
 	mem_config_ndelay(100);
 
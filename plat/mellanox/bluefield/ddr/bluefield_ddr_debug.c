@@ -82,7 +82,7 @@
 #define RECORD_GET_DATA(type, idx) (reg_info[type].reg_data[dp->mss_index][idx])
 
 extern int ddr_do_actual_setup(void);
-extern int ddr_get_info_rest(struct ddr_params *dp);
+extern int ddr_get_info_rest(struct ddr_params *p);
 
 struct per_data_lane_data {
 	uint8_t lane_num;
@@ -158,6 +158,8 @@ int eye_2d_inhvt = 0; /* Set to enable setting INHVT when do eye plotting. */
 int phy_bist_cycle = 0x20;	/* The PHY BIST burst cycle. */
 int phy_bist_loop = 1; /* Times phy bist is run before calling pass */
 int display_eye_plot = 1; /* Whether to display the 2d eye plot result graph. */
+/* How the 2d eye plot finds the passing region of each Vref row. */
+enum { EYE_2D_FULL, EYE_2D_EDGE } eye_2d_scan = EYE_2D_EDGE;
 /* The way to restore the Vref after a 2d write eye plot. */
 enum { W2DR_PER_DRAM, W2DR_STATIC, W2DR_RANK_AVG} w2d_vref_rstr = W2DR_RANK_AVG;
 
@@ -376,6 +378,7 @@ static void set_bdlr_bd_field(int bl_idx, int bit_idx, int nibble,
 
 static void phy_bist_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	PUB_BISTRR_t bistrr;
 	PUB_BISTAR1_t bistar1;
 	PUB_BISTAR2_t bistar2;
@@ -532,6 +535,7 @@ static int get_entered_mss_map(char * const arg)
  */
 int ddr_operating_frequency_change(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	unsigned int mss_map, freq_khz;
 	int dot_place = -1;
 	uint64_t tck;
@@ -597,6 +601,7 @@ int ddr_operating_frequency_change(int argc, char * const argv[])
 
 		if (!ddr_switch_current_mss(i))
 			continue;
+		dp = ddr_cur_dp();
 
 		prev_tck = dp->tck;
 		dp->tck = tck;
@@ -666,6 +671,7 @@ int find_record(int reg_type, int addr_mode, int address, char *name)
 static void reg_record(int reg_type, int reg_idx,
 		       __attribute__((unused)) int val)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int offset = 0;
 	if (reg_type == PUB_RANK_REG)
 		offset= GET_MEM_REG_FIELD(pub, PUB_RANKIDR, rankrid) *
@@ -684,6 +690,7 @@ static void reg_record(int reg_type, int reg_idx,
 static void reg_restore(int reg_type, int reg_idx,
 			__attribute__((unused)) int val)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t write_val;
 	int offset = 0;
 
@@ -739,6 +746,7 @@ static void reg_read(int reg_type, int reg_idx, __attribute__((unused)) int val)
  */
 int do_ddr_basic(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	unsigned int mss_map;
 	int all = 0;
 	int reg_type;
@@ -828,6 +836,7 @@ int do_ddr_basic(int argc, char * const argv[])
 			continue;
 		if (!ddr_switch_current_mss(i))
 			continue;
+		dp = ddr_cur_dp();
 
 		if (all) {
 			for (int j = 0; j < reg_info[reg_type].reg_num; j++)
@@ -1063,6 +1072,8 @@ int do_ato_probing(int argc, char * const argv[])
  */
 int do_vref_probing(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	enum {VREF_PROBE_AC, VREF_PROBE_ZQ, VREF_PROBE_DQ};
 
 	int mss_idx, vref_module, rank_idx, bl_idx;
@@ -1097,6 +1108,7 @@ int do_vref_probing(int argc, char * const argv[])
 		tf_printf("MSS%d not configured!\n", mss_idx);
 		return -1;
 	}
+	dp = ddr_cur_dp();
 
 	if (vref_module == VREF_PROBE_DQ) {
 		if ((dp->active_ranks & (1 << rank_idx)) == 0) {
@@ -1176,6 +1188,7 @@ static int get_tap_delay(char *const arg, int *tap, int *is_ps)
 /* Convert a TAP delay from PS to raw TAPs. */
 static inline int convert_tap(int tap_delay, int is_ps, int bl_idx)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int tap_fs_delay;
 	int is_neg;
 	int bl_iprd;
@@ -1206,6 +1219,7 @@ static inline int convert_tap(int tap_delay, int is_ps, int bl_idx)
 /* Modify a Single Byte Lane Read/Write Centralization TAP. */
 int edit_xctap(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int parsed;
 	int rank_idx, bl_idx, nb_idx, tap_delay, is_ps;
 	int tr_res, bl_iprd;
@@ -1238,6 +1252,7 @@ int edit_xctap(int argc, char * const argv[])
 		tf_printf("Entered MSS not present or has no DIMMs present.\n");
 		return -1;
 	}
+	dp = ddr_cur_dp();
 
 	if ((dp->active_ranks & (1 << rank_idx)) == 0) {
 		tf_printf("Entered rank not valid present in MSS.\n");
@@ -1573,6 +1588,7 @@ int do_edit_tap_results(int argc, char * const argv[])
 static int edit_sdram_vref(int dimm_idx,int rank_idx,int bl_idx,
 			   int nb_idx,int vref_val)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int phy_rank;
 	uint32_t mc_ddr_if;
 	uint32_t sdram_vref_val, sdram_vref_rng, sdram_vref_data;
@@ -1701,6 +1717,7 @@ static int edit_sdram_vref(int dimm_idx,int rank_idx,int bl_idx,
 static int edit_ddr_phy_vref(int dimm_idx,int rank_idx,int bl_idx,
 			     int nb_idx,int vref_val)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int phy_rank;
 	uint32_t vdq_isel;
 	uint32_t mc_ddr_if;
@@ -1734,6 +1751,7 @@ static int edit_ddr_phy_vref(int dimm_idx,int rank_idx,int bl_idx,
 /* This command modifies the Vref results. */
 int do_vref(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int parsed, op;
 	int mss_idx, dimm_idx, rank_idx, bl_idx, vref_val;
 	int nb_idx = 0;
@@ -1764,6 +1782,7 @@ int do_vref(int argc, char * const argv[])
 		tf_printf("MSS%d not configured!\n", mss_idx);
 		return -1;
 	}
+	dp = ddr_cur_dp();
 
 	if (dp->dimm[dimm_idx].ranks == 0) {
 		tf_printf("Entered DIMM not present in MSS.\n");
@@ -2054,6 +2073,7 @@ uint32_t mod_bdlr_bd_field(int offset, void *extra)
  */
 void show_skew_margin(int rank_idx, int is_write, int bl_map, int bit_map)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int status;
 	uint32_t bl_iprd;
 	uint32_t bl_tap_fs;
@@ -2204,6 +2224,7 @@ DEFINE_MOD_LCDLRn_FIELD(4, x4rdqsnd)
 void show_centralization_margin(int rank_idx, int is_write, int bl_map,
 				int nb_map)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t bl_iprd;
 	uint32_t bl_tap_fs;
 	uint32_t ret_status = 0;
@@ -2668,6 +2689,7 @@ static void print_eye_margin_summary(struct per_bytelane_margin *pbm,
 				     struct per_bl_eye_data *data,
 				     int count, int is_write)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t central_left_marg_fs = 0;
 	uint32_t central_right_marg_fs = 0;
 	uint32_t vref_high_marg_volt_mul100 = 0;
@@ -2748,6 +2770,7 @@ static void print_eye_margin_summary(struct per_bytelane_margin *pbm,
 
 static uint32_t d2_write_change_vref(int vref_idx, int bl_idx, int rank_idx)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t mr6_temp;
 	int vref_range, vref_range_val;
 	int phy_rank = 4 * rank_idx;
@@ -2914,6 +2937,7 @@ static uint32_t d2_read_record_bl_data(int bl_idx, int rank_idx,
 				       struct per_bl_eye_data *data,
 				       int is_x4_other_nibble)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	PUB_DXnGCR5_t dx_x_gcr5;
 	PUB_DXnGCR8_t dx_x_gcr8;
 	PUB_DXnMDLR0_t dx_x_mdlr0;
@@ -2998,6 +3022,7 @@ static uint32_t d2_write_record_bl_data(int bl_idx, int rank_idx,
 					struct per_bl_eye_data *data,
 					int is_x4_other_nibble)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	PUB_DXnMDLR0_t dx_x_mdlr0;
 	PUB_DXnLCDLR1_t dx_x_lcdlr1;
 
@@ -3053,6 +3078,8 @@ static uint32_t d2_write_restore_bl_data(int bl_idx, int rank_idx,
 /* We can only restore the write Vref values per rank. */
 static uint32_t d2_write_restore_rank(int rank_idx)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/*
 	 * Restore the Vref previous values.
 	 * We should be calling the per_dram_addressability_vref_setup()
@@ -3140,6 +3167,7 @@ static int d2_eye_dll_ops(int bl_idx, int dll_idx, uint32_t *bist_result,
 			  struct per_bl_eye_data *data, int is_x4_other_nibble,
 			  int is_write)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t pbist_dqmask;
 
 	d2_eye_op[is_write].change_dll(dll_idx, bl_idx, data,
@@ -3187,6 +3215,123 @@ static int d2_eye_vref_ops(int bl_idx, int rank_idx, int vref_idx,
 	return 1;
 }
 
+/* Step used to look for a passing DLL value when the row seed fails. */
+#define D2_EYE_SEARCH_STEP	4
+
+/*
+ * Run the PHY BIST at one DLL value of the current Vref row.
+ * Writes 1 to *pass if the BIST passed, 0 if it failed.
+ * Return 1 if success or 0 if phy bist timed out.
+ */
+static int d2_eye_dll_probe(int bl_idx, int dll_idx, int *pass,
+			    struct per_bl_eye_data *data,
+			    int is_x4_other_nibble, int is_write)
+{
+	uint32_t bist_result;
+
+	if (!d2_eye_dll_ops(bl_idx, dll_idx, &bist_result, data,
+			    is_x4_other_nibble, is_write))
+		return 0;
+
+	*pass = !bist_result;
+
+	return 1;
+}
+
+/*
+ * Edge search version of d2_eye_vref_ops(). Rather than running the PHY BIST
+ * at every DLL value, look for one passing DLL value starting at *center and
+ * then binary search the left and right edges of the eye around it. Every DLL
+ * value between the two edges is recorded as passing, everything else as
+ * failing, so an eye is assumed to have no holes in it.
+ * On return *center holds the middle of the eye found in this row (which is
+ * a good start for the next row), or -1 if no DLL value passed.
+ * Return 1 if success or 0 if phy bist timed out.
+ */
+static int d2_eye_vref_search(int bl_idx, int rank_idx, int vref_idx,
+			      struct per_bl_eye_data *data, int *res_2d,
+			      int is_x4_other_nibble, int is_write,
+			      int *center)
+{
+	int max_dll = data->bl_iprd + 10 * is_write;
+	int seed, left_fail, right_fail;
+	int pass_idx = INVALID_VAL;
+	int pass;
+
+	max_dll = MIN(max_dll, D2_DLL_MAX_VAL - 1);
+	seed = MIN(MAX(*center, 0), max_dll);
+	left_fail = -1;
+	right_fail = max_dll + 1;
+
+	if (d2_eye_op[is_write].change_vref(vref_idx, bl_idx, rank_idx))
+		return 0;
+
+	/* Find a passing DLL value, moving outwards from the seed. */
+	for (int dist = 0; seed - dist >= 0 || seed + dist <= max_dll;
+	     dist += D2_EYE_SEARCH_STEP) {
+		if (seed - dist >= 0) {
+			if (!d2_eye_dll_probe(bl_idx, seed - dist, &pass, data,
+					      is_x4_other_nibble, is_write))
+				return 0;
+			if (pass) {
+				pass_idx = seed - dist;
+				if (dist)
+					right_fail = pass_idx +
+						     D2_EYE_SEARCH_STEP;
+				break;
+			}
+		}
+		if (dist && seed + dist <= max_dll) {
+			if (!d2_eye_dll_probe(bl_idx, seed + dist, &pass, data,
+					      is_x4_other_nibble, is_write))
+				return 0;
+			if (pass) {
+				pass_idx = seed + dist;
+				left_fail = pass_idx - D2_EYE_SEARCH_STEP;
+				break;
+			}
+		}
+	}
+
+	if (pass_idx == INVALID_VAL) {
+		*center = -1;
+		return 1;
+	}
+
+	/* Left edge: left_fail failed (or is out of range), lo passed. */
+	for (int lo = pass_idx; lo - left_fail > 1;) {
+		int mid = left_fail + (lo - left_fail) / 2;
+
+		if (!d2_eye_dll_probe(bl_idx, mid, &pass, data,
+				      is_x4_other_nibble, is_write))
+			return 0;
+		if (pass)
+			lo = mid;
+		else
+			left_fail = mid;
+	}
+
+	/* Right edge: hi passed, right_fail failed (or is out of range). */
+	for (int hi = pass_idx; right_fail - hi > 1;) {
+		int mid = hi + (right_fail - hi) / 2;
+
+		if (!d2_eye_dll_probe(bl_idx, mid, &pass, data,
+				      is_x4_other_nibble, is_write))
+			return 0;
+		if (pass)
+			hi = mid;
+		else
+			right_fail = mid;
+	}
+
+	for (int dll_idx = left_fail + 1; dll_idx < right_fail; dll_idx++)
+		SET_D2_BIST_RESULT(res_2d, dll_idx, D2_BIST_PASS);
+
+	*center = (left_fail + right_fail) / 2;
+
+	return 1;
+}
+
 /*
  * Do the per bytelane operation of the 2D write eye plotting.
  * Return 1 if success or 0 if phy bist timed out.
@@ -3199,6 +3344,7 @@ static int d2_eye_bytelane_ops(int bl_idx,
 			       int is_write)
 {
 	PUB_BISTRR_t bistrr;
+	int center, eye_found = 0;
 
 	int (*res_2d)[D2_DLL_INT_USED] = dbg_arrays.dlep.res_2d;
 
@@ -3211,14 +3357,40 @@ static int d2_eye_bytelane_ops(int bl_idx,
 	bistrr.bdxsel = bl_idx;
 	pub_write(PUB_BISTRR, bistrr.word);
 
+	/*
+	 * In edge search mode each row starts looking at the middle of the
+	 * row above it, starting with the trained DLL value. The rows are
+	 * done from the highest Vref down, so once a row has passed, the
+	 * first row without any passing DLL value closes the bottom of the
+	 * eye and the remaining rows are left as failed.
+	 */
+	center = is_write ? data->d2.wr.wdqd_tr_val :
+		 MIN(data->d2.rd.rdqsd_tr_val, data->d2.rd.rdqsnd_tr_val);
+
 	for (int vref_idx = D2_VREF_MAX_VAL - 1; vref_idx >= 0;
 	     vref_idx--) {
+		int prev_center = center;
+
+		if (eye_2d_scan == EYE_2D_FULL) {
+			if (!d2_eye_vref_ops(bl_idx, rank_idx, vref_idx, data,
+					     res_2d[vref_idx],
+					     is_x4_other_nibble,
+					     is_write))
+				return 0;
+			continue;
+		}
 
-		if (!d2_eye_vref_ops(bl_idx, rank_idx, vref_idx, data,
-				     res_2d[vref_idx],
-				     is_x4_other_nibble,
-				     is_write))
+		if (!d2_eye_vref_search(bl_idx, rank_idx, vref_idx, data,
+					res_2d[vref_idx], is_x4_other_nibble,
+					is_write, &center))
 			return 0;
+
+		if (center >= 0)
+			eye_found = 1;
+		else if (eye_found)
+			break;
+		else
+			center = prev_center;
 	}
 
 	/* Restore the previous DLL and Vref values for this bytelane. */
@@ -3253,6 +3425,7 @@ static int d2_eye_bytelane_ops(int bl_idx,
 
 void d2_eye_plotting(int rank_idx, int is_write, int bl_map, int nb_map)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	struct per_bl_eye_data *data = dbg_arrays.dlep.res_vrt;
 	struct per_bytelane_margin *pbm = dbg_arrays.dlep.pbm;
 	int count = 0;
@@ -3318,6 +3491,7 @@ void d2_eye_plotting(int rank_idx, int is_write, int bl_map, int nb_map)
 
 int do_marg_and_d2(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int mss_map, rank_idx, is_write, parsed;
 	uint32_t reg_data;
 	void (*op)(int rank_idx, int is_write, int bl_map, int bit_nb_map);
@@ -3379,6 +3553,7 @@ int do_marg_and_d2(int argc, char * const argv[])
 			continue;
 		if (!ddr_switch_current_mss(i))
 			continue;
+		dp = ddr_cur_dp();
 
 		if ((dp->active_ranks & (1 << rank_idx)) == 0) {
 			tf_printf("Rank %d not valid present in MSS%d.\n",
@@ -3467,6 +3642,8 @@ static enum ddr_rzq get_rzq(char *const arg, int *success)
 /* Function which manages the DDR params struct. */
 int ddr_params(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 /*
  * Piece of code which checks if the field specified is the one
  * given and update the corresponding parameter.
@@ -3502,6 +3679,7 @@ int ddr_params(int argc, char * const argv[])
 		tf_printf("MSS%d not configured!\n", mss_idx);
 		return -1;
 	}
+	dp = ddr_cur_dp();
 
 	if (action == PARAM_SHOW) {
 		print_ddr_params(dp);
@@ -3550,6 +3728,7 @@ int ddr_params(int argc, char * const argv[])
 
 int ddr_sweep(int argc, char * const argv[])
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int parsed;
 	int min, step, max;
 	int mss_idx;
@@ -3615,6 +3794,7 @@ int ddr_sweep(int argc, char * const argv[])
 		tf_printf("MSS%d not configured!\n", mss_idx);
 		return -1;
 	}
+	dp = ddr_cur_dp();
 
 	/* Backup the original value. */
 	memcpy(&original_val, (char *)dp + offset, param_size);
@@ -3798,6 +3978,23 @@ static const struct setting_var params_info[] = { {
 			.desc = "Only final summary is displayed",
 		},},
 	} },
+}, {
+	.name = "eye_2d_scan",
+	.desc = "How the passing region of each 2D eye plot row is found",
+	.addr = (int *)&eye_2d_scan,
+	.type = TYPE_STR,
+	.val = {.str = {
+		.num = 2,
+		.vals = (const struct setting_param_val[]){{
+			.val = EYE_2D_EDGE,
+			.name = "edge",
+			.desc = "Binary search the eye edges of each row",
+		}, {
+			.val = EYE_2D_FULL,
+			.name = "full",
+			.desc = "Run the PHY BIST at every DLL value",
+		},},
+	} },
 }, {
 	.name = "w2d_vref_restore",
 	.desc = "How Vref is restored after a write 2d eye plot",
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arch_helpers.h>
+#include <bakery_lock.h>
+#include <cassert.h>
+#include <console.h>
+#include <debug.h>
+#include <delay_timer.h>
+#include <mmio.h>
+#include <platform.h>
+#include <utils_def.h>
+#include "bluefield_ddr.h"
+#include "bluefield_ddr_engine.h"
+#include "bluefield_def.h"
+#include "rsh.h"
+
+/*
+ * Cores 0 and 1 are never used as DDR engines, they are respectively the
+ * boot core and the flash engine.
+ */
+#define DDR_ENGINE_FIRST_CORE		2
+
+/* How long to wait for an engine to leave the holding pen. */
+#define DDR_ENGINE_WAKEUP_TIMEOUT_US	100000
+
+/*
+ * How long to wait for the engines to finish. The worst case of
+ * ddr_do_actual_setup() is a failed attempt with the cached training
+ * results followed by a full training, each being allowed the time of
+ * DDR_ENGINE_TRAIN_TIMEOUT_MS.
+ */
+#define DDR_ENGINE_TRAIN_TIMEOUT_MS	30000
+#define DDR_ENGINE_DONE_TIMEOUT_MS	(2 * DDR_ENGINE_TRAIN_TIMEOUT_MS)
+
+#define DDR_ENGINE_NO_CORE		0xffffffff
+
+/* Lowest address of the stack of the engine working on a slot. */
+#define DDR_ENGINE_STACK_BASE(idx)	(DDR_ENGINE_STACK_START - \
+					 ((idx) + 1) * DDR_ENGINE_STACK_SIZE)
+
+CASSERT(sizeof(struct ddr_engine_slot) == DDR_ENGINE_SLOT_SIZE,
+	assert_ddr_engine_slot_size_mismatch);
+CASSERT(__builtin_offsetof(struct ddr_engine_slot, core) ==
+	DDR_ENGINE_SLOT_CORE, assert_ddr_engine_slot_core_mismatch);
+CASSERT(DDR_ENGINE_STACK_BASE(MAX_MEM_CTRL - 1) >= BL31_BASE,
+	assert_ddr_engine_stacks_fit_in_bl31_area);
+
+IMPORT_SYM(uintptr_t, __DATA_START__, BL2_DATA_START);
+IMPORT_SYM(uintptr_t, __DATA_END__, BL2_DATA_END);
+IMPORT_SYM(uintptr_t, __BSS_START__, BL2_BSS_START);
+IMPORT_SYM(uintptr_t, __BSS_END__, BL2_BSS_END);
+
+extern void ddr_engine_ep(void);
+void ddr_engine_do_setup(unsigned int idx);
+
+/*
+ * Everything shared with the engines lives in coherent memory, since the
+ * engines run with their caches off while the boot core has them on.
+ */
+struct ddr_engine_slot ddr_engine_slots[MAX_MEM_CTRL]
+	__section("tzfw_coherent_mem");
+static bakery_lock_t ddr_engine_locks[DDR_ENGINE_LOCK_NUM]
+	__section("tzfw_coherent_mem");
+
+/* Bitmap of the MSSes handed to an engine, and whether we hand them out. */
+static uint32_t ddr_engine_queued __section("tzfw_coherent_mem");
+static int ddr_engine_collecting __section("tzfw_coherent_mem");
+
+void ddr_engine_lock(unsigned int lock_id)
+{
+	assert(lock_id < DDR_ENGINE_LOCK_NUM);
+	bakery_lock_get(&ddr_engine_locks[lock_id]);
+}
+
+void ddr_engine_unlock(unsigned int lock_id)
+{
+	assert(lock_id < DDR_ENGINE_LOCK_NUM);
+	bakery_lock_release(&ddr_engine_locks[lock_id]);
+}
+
+/*
+ * Start collecting the MSSes to train. From now on, bluefield_setup_mss()
+ * only gathers the DIMM information and leaves the actual setup to an
+ * engine when one is available, until ddr_engine_run() is called.
+ */
+void ddr_engine_begin(void)
+{
+	for (int i = 0; i < MAX_MEM_CTRL; i++) {
+		ddr_engine_slots[i].core = DDR_ENGINE_NO_CORE;
+		ddr_engine_slots[i].state = DDR_ENGINE_IDLE;
+		ddr_engine_slots[i].result = 0;
+		ddr_engine_slots[i].stack_overflow = 0;
+	}
+	ddr_engine_queued = 0;
+	ddr_engine_collecting = 1;
+}
+
+/* Return 1 if the given core is free to be used as a DDR engine. */
+static int ddr_engine_core_available(unsigned int core, uint64_t cluster_ena)
+{
+	if (core == plat_my_core_pos())
+		return 0;
+
+	if (!((cluster_ena >> (core / BF_MAX_CPUS_PER_CLUSTER)) & 1))
+		return 0;
+
+	for (int i = 0; i < MAX_MEM_CTRL; i++)
+		if (ddr_engine_slots[i].core == core)
+			return 0;
+
+	return 1;
+}
+
+/*
+ * Hand the setup of the MSS described by p to an engine.
+ * Return 1 if an engine will train it or 0 if the caller must do it.
+ */
+int ddr_engine_queue(struct ddr_params *p)
+{
+	RSH_TILE_STATUS_t rts;
+	unsigned int core;
+
+	if (!ddr_engine_collecting)
+		return 0;
+
+	assert(p->mss_index < MAX_MEM_CTRL);
+
+	rts.word = mmio_read_64(RSHIM_BASE + RSH_TILE_STATUS);
+
+	for (core = DDR_ENGINE_FIRST_CORE; core < PLATFORM_CORE_COUNT; core++)
+		if (ddr_engine_core_available(core, rts.cluster_ena))
+			break;
+
+	if (core == PLATFORM_CORE_COUNT)
+		return 0;
+
+	ddr_core_dp[core] = p;
+	ddr_engine_slots[p->mss_index].core = core;
+	ddr_engine_queued |= 1 << p->mss_index;
+
+	return 1;
+}
+
+/*
+ * Release the queued engines from the holding pen. The CPU bitmap is
+ * rewritten until every engine is out, as the flash engine clears it
+ * when it goes back to standby.
+ */
+static void ddr_engine_wakeup(void)
+{
+	uintptr_t *mailbox = (void *) MBOX_BASE;
+	uint64_t *cpu_bitmap = (uint64_t *)&mailbox[1];
+	uint64_t pending;
+
+	*mailbox = (uintptr_t) ddr_engine_ep;
+
+	for (int i = 0; i < MAX_MEM_CTRL; i++)
+		if ((ddr_engine_queued >> i) & 1)
+			ddr_engine_slots[i].state = DDR_ENGINE_LAUNCHED;
+
+	mmio_write_64(RSHIM_BASE + RSH_SCRATCHPAD4, 1);
+
+	for (int t = 0; t < DDR_ENGINE_WAKEUP_TIMEOUT_US; t++) {
+		pending = 0;
+		for (int i = 0; i < MAX_MEM_CTRL; i++)
+			if (ddr_engine_slots[i].state == DDR_ENGINE_LAUNCHED)
+				pending |= 1ULL << ddr_engine_slots[i].core;
+		if (pending == 0)
+			break;
+
+		cpu_bitmap[0] = pending;
+		cpu_bitmap[1] = 0;
+		flush_dcache_range((uintptr_t) mailbox,
+			   (uintptr_t) &cpu_bitmap[2] - (uintptr_t) mailbox);
+		dsbsy();
+		sev();
+		udelay(1);
+	}
+
+	cpu_bitmap[0] = 0;
+	cpu_bitmap[1] = 0;
+	flush_dcache_range((uintptr_t) mailbox,
+			   (uintptr_t) &cpu_bitmap[2] - (uintptr_t) mailbox);
+	dsbsy();
+
+	/*
+	 * Take back the MSSes whose engine never showed up, they get set
+	 * up by the boot core once the others are done.
+	 */
+	ddr_engine_lock(DDR_ENGINE_LOCK_SLOT);
+	for (int i = 0; i < MAX_MEM_CTRL; i++) {
+		if (ddr_engine_slots[i].state == DDR_ENGINE_LAUNCHED)
+			ddr_engine_slots[i].state = DDR_ENGINE_IDLE;
+	}
+	ddr_engine_unlock(DDR_ENGINE_LOCK_SLOT);
+}
+
+/*
+ * Wait for the running engines to be done, giving up on those which take
+ * longer than DDR_ENGINE_DONE_TIMEOUT_MS. Their slot is marked as timed
+ * out so that the boot core sets the MSS up itself, and so that the engine
+ * leaves the slot alone if it ever completes.
+ */
+static void ddr_engine_wait(void)
+{
+	uint64_t deadline = read_cntpct_el0() +
+		(uint64_t)plat_get_syscnt_freq2() / 1000 *
+		DDR_ENGINE_DONE_TIMEOUT_MS;
+
+	for (int i = 0; i < MAX_MEM_CTRL; i++) {
+		if (ddr_engine_slots[i].state == DDR_ENGINE_IDLE)
+			continue;
+
+		while (ddr_engine_slots[i].state != DDR_ENGINE_DONE &&
+		       read_cntpct_el0() < deadline)
+			udelay(1);
+
+		ddr_engine_lock(DDR_ENGINE_LOCK_SLOT);
+		if (ddr_engine_slots[i].state != DDR_ENGINE_DONE) {
+			ERROR("DDR engine on core %d timed out on MSS %d\n",
+			      ddr_engine_slots[i].core, i);
+			ddr_engine_slots[i].state = DDR_ENGINE_TIMEOUT;
+		}
+		ddr_engine_unlock(DDR_ENGINE_LOCK_SLOT);
+	}
+}
+
+/*
+ * Train all the queued MSSes in parallel and wait for them to complete.
+ * Return a bitmap of the MSSes which failed to be set up.
+ */
+uint32_t ddr_engine_run(void)
+{
+	uint32_t failed = 0;
+	int ret;
+
+	if (!ddr_engine_collecting)
+		return 0;
+
+	ddr_engine_collecting = 0;
+
+	if (ddr_engine_queued == 0)
+		return 0;
+
+	/*
+	 * The engines access memory with their caches off, so write back
+	 * everything they might read; that is the DDR parameters, the
+	 * console state and the other globals.
+	 */
+	console_flush();
+	flush_dcache_range(BL2_DATA_START, BL2_DATA_END - BL2_DATA_START);
+	flush_dcache_range(BL2_BSS_START, BL2_BSS_END - BL2_BSS_START);
+
+	ddr_engine_wakeup();
+	ddr_engine_wait();
+
+	/*
+	 * Drop whatever got speculatively fetched while the engines were
+	 * writing the same globals behind our back.
+	 */
+	inv_dcache_range(BL2_DATA_START, BL2_DATA_END - BL2_DATA_START);
+	inv_dcache_range(BL2_BSS_START, BL2_BSS_END - BL2_BSS_START);
+
+	for (int i = 0; i < MAX_MEM_CTRL; i++) {
+		if (!((ddr_engine_queued >> i) & 1))
+			continue;
+
+		if (ddr_engine_slots[i].state == DDR_ENGINE_IDLE ||
+		    ddr_engine_slots[i].state == DDR_ENGINE_TIMEOUT) {
+			if (ddr_engine_slots[i].state == DDR_ENGINE_IDLE)
+				WARN("DDR engine on core %d did not start\n",
+				     ddr_engine_slots[i].core);
+			ddr_set_cur_dp(&dps[i]);
+			ret = ddr_do_actual_setup();
+		} else if (ddr_engine_slots[i].stack_overflow) {
+			ERROR("DDR engine on core %d overflowed its stack\n",
+			      ddr_engine_slots[i].core);
+			ret = 0;
+		} else {
+			ret = ddr_engine_slots[i].result;
+		}
+
+		if (!ret) {
+			MEM_ERR("Initializing DDR on MSS %d failed!\n", i);
+			failed |= 1 << i;
+		} else {
+			NOTICE("Finished initializing DDR on MSS %d!\n", i);
+		}
+	}
+
+	return failed;
+}
+
+/*
+ * This function is executed by the secondary core (i.e. engine) to train
+ * the MSS of the given slot.
+ */
+void ddr_engine_do_setup(unsigned int idx)
+{
+	struct ddr_engine_slot *slot = &ddr_engine_slots[idx];
+	volatile uint64_t *guard =
+		(uint64_t *)(uintptr_t)DDR_ENGINE_STACK_BASE(idx);
+	int started = 0;
+
+	ddr_engine_lock(DDR_ENGINE_LOCK_SLOT);
+	if (slot->state == DDR_ENGINE_LAUNCHED) {
+		slot->state = DDR_ENGINE_RUNNING;
+		started = 1;
+	}
+	ddr_engine_unlock(DDR_ENGINE_LOCK_SLOT);
+
+	if (!started)
+		return;
+
+	for (int i = 0; i < DDR_ENGINE_STACK_GUARD_WORDS; i++)
+		guard[i] = DDR_ENGINE_STACK_CANARY;
+
+	slot->result = ddr_do_actual_setup();
+
+	for (int i = 0; i < DDR_ENGINE_STACK_GUARD_WORDS; i++)
+		if (guard[i] != DDR_ENGINE_STACK_CANARY)
+			slot->stack_overflow = 1;
+
+	ddr_engine_lock(DDR_ENGINE_LOCK_SLOT);
+	if (slot->state == DDR_ENGINE_RUNNING)
+		slot->state = DDR_ENGINE_DONE;
+	ddr_engine_unlock(DDR_ENGINE_LOCK_SLOT);
+}
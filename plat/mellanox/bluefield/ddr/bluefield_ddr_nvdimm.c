@@ -68,6 +68,22 @@
  */
 #define NVDIMM_ARS_COUNT_DOWN		4096
 
+/*
+ * Each down-counter interrupt scrubs one block. The block size adapts to the
+ * observed read latency: it doubles while a block takes less than half of
+ * NVDIMM_ARS_BLOCK_BUDGET_US and halves when a block exceeds it, so large
+ * NVDIMMs are scrubbed in few interrupts without holding EL3 for too long.
+ */
+#define NVDIMM_ARS_MIN_BLOCK_SIZE	NVDIMM_ARS_BLOCK_SIZE
+#define NVDIMM_ARS_MAX_BLOCK_SIZE	(NVDIMM_ARS_BLOCK_SIZE * 256)
+#define NVDIMM_ARS_BLOCK_BUDGET_US	20
+
+/*
+ * Query ARS Status flag (ACPI 6.2 Table 9-303): the error record buffer
+ * overflowed, scrub can be resumed from restart_pa / restart_len.
+ */
+#define NVDIMM_ARS_FLAG_OVERFLOW	0x1
+
 /* DIMM ID to I2C address mapping. */
 const uint8_t csr_i2c_addr[MAX_DIMM_NUM] = {
 	I2C_DIMM_0_ADDR, I2C_DIMM_1_ADDR, I2C_DIMM_2_ADDR, I2C_DIMM_3_ADDR };
@@ -154,7 +170,8 @@ struct bf_ars {
         uint8_t unuse1[4];	/* Unused. */
 	uint64_t start_pa;	/* ARS start address (PA). */
 	uint64_t start_len;	/* ARS start length. */
-	uint64_t unuse2[5];	/* Unused. */
+	uint64_t scrubbed;	/* Bytes scrubbed so far (progress). */
+	uint64_t unuse2[4];	/* Unused. */
 
 	union {
 		/* Query ARS Status output (ACPI 6.2 Table 9-303). */
@@ -245,6 +262,10 @@ struct bf_efi {
 	/* Reserved for the UEFI SystemTable pointer */
 	void *efi_sys_tbl;
 
+	/* Boot log region (0 if none), to be kept away from the OS. */
+	uint64_t boot_log;
+	uint32_t boot_log_size;
+
 	/*
 	 * ARS (address range scrub) structure.
 	 * Make it aligned so it could start from offset NVDIMM_ARS_OFF in
@@ -329,9 +350,13 @@ static uint32_t nvdimm_get_timeout(uint32_t dimm, uint32_t offset_0,
 {
 	uint32_t timeout = max_ms;
 	uint8_t lo_value, hi_value;
+	i2c_smbus_msg_t msgs[2] = {
+		{ I2C_FLAG_READ, csr_i2c_addr[dimm], offset_0, 1, &lo_value },
+		{ I2C_FLAG_READ, csr_i2c_addr[dimm], offset_1, 1, &hi_value },
+	};
 
-	if (bluefield_ddr_read_reg(dimm, &lo_value, offset_0) == 0 &&
-	    bluefield_ddr_read_reg(dimm, &hi_value, offset_1) == 0) {
+	/* Read both halves in one transfer. */
+	if (i2c_smbus_transfer_msgs(msgs, 2) == 0) {
 		timeout = (hi_value << 8) + lo_value;
 
 		/* Check whether the time unit is in seconds. */
@@ -504,6 +529,11 @@ void bluefield_setup_efi_info(uintptr_t addr)
 	/* Set the flag to indicate whether the FW recovery is needed. */
 	efi_info->fw_recovery = (boot_on_spi_flash_recovery != 0);
 
+	/* Tell UEFI and BL31 where the boot log is. */
+	efi_info->boot_log = bf_boot_log_base();
+	if (efi_info->boot_log)
+		efi_info->boot_log_size = BF_BOOT_LOG_SIZE;
+
 	/* Make sure it's not out-of-boundary. */
 	assert(sizeof(*efi_info) <= EFI_INFO_SIZE);
 	assert((uintptr_t)&((struct bf_efi *)0)->ars == NVDIMM_ARS_OFF);
@@ -732,18 +762,21 @@ void bluefield_setup_nvdimm_restore(void)
 /* Pointer to the efi info structure. */
 struct bf_efi *efi_info;
 
+/* Length of the block being scrubbed, and the current adaptive block size. */
+static uint64_t nvdimm_ars_cur_len;
+static uint64_t nvdimm_ars_blk_size = NVDIMM_ARS_MIN_BLOCK_SIZE;
+
 /*
  * Access a memory range to detect the errors.
  *
  * Read the first 8 bytes of each cacheline. Since error exception (SError) is
  * asynchronous, waiting for the exception for each cacheline seems inefficient.
- * As an optimization, this function initiates the read for the whole block(4KB)
+ * As an optimization, this function initiates the read for the whole block
  * and checks the result in the next down-counter interrupt which should have
  * given enough time for the SError to occur and finish. The down-counter is
  * programmed as 4096 (NVDIMM_ARS_COUNT_DOWN), which is around 4 microseconds
- * depending on the clock. If no error is detected, the 4KB memory read should
- * be done within 2us, and leave 2us to handle one serror interrupt. This
- * function will exit after one error is detected.
+ * depending on the clock. This function will stop issuing reads once an error
+ * is detected; the failing lines are then located by nvdimm_ars_locate().
  */
 static __always_inline inline
 void nvdimm_ars_scrub(volatile struct bf_ars *ars, uint64_t pa, uint64_t len)
@@ -825,6 +858,130 @@ static void nvdimm_ars_set_ext_status(struct bf_ars *ars, uint16_t status)
 	ars->output.query.ext_status = status;
 }
 
+/*
+ * Length of the next block to scrub at restart_pa: the adaptive block size,
+ * clipped to the remaining range and to the end of the NVDIMM region so that
+ * a block never spills over into another DIMM.
+ */
+static uint64_t nvdimm_ars_block_len(struct bf_ars *ars)
+{
+	struct bf_efi_mem_region *region = &efi_info->region[ars->handle - 1];
+	uint64_t pa = ars->output.query.restart_pa;
+	uint64_t len = nvdimm_ars_blk_size;
+
+	if (len > ars->output.query.restart_len)
+		len = ars->output.query.restart_len;
+	if (pa + len > region->phy_addr + region->length)
+		len = region->phy_addr + region->length - pa;
+
+	return len;
+}
+
+/* Grow or shrink the block size based on how long the last block took. */
+static void nvdimm_ars_adapt_block_size(uint64_t ticks, uint64_t len)
+{
+	uint64_t budget = read_cntfrq_el0() / 1000000 *
+			  NVDIMM_ARS_BLOCK_BUDGET_US;
+
+	/* Only full blocks tell us something about the throughput. */
+	if (len != nvdimm_ars_blk_size)
+		return;
+
+	if (ticks > budget &&
+	    nvdimm_ars_blk_size > NVDIMM_ARS_MIN_BLOCK_SIZE)
+		nvdimm_ars_blk_size /= 2;
+	else if (ticks < budget / 2 &&
+		 nvdimm_ars_blk_size < NVDIMM_ARS_MAX_BLOCK_SIZE)
+		nvdimm_ars_blk_size *= 2;
+}
+
+/* Start scrubbing the block at restart_pa. */
+static __always_inline inline void nvdimm_ars_start_block(struct bf_ars *ars)
+{
+	uint64_t start;
+
+	nvdimm_ars_cur_len = nvdimm_ars_block_len(ars);
+	ars->serror = 0;
+
+	start = read_cntpct_el0();
+	nvdimm_ars_scrub(ars, ars->output.query.restart_pa,
+			 nvdimm_ars_cur_len);
+	if (!ars->serror)
+		nvdimm_ars_adapt_block_size(read_cntpct_el0() - start,
+					    nvdimm_ars_cur_len);
+}
+
+/*
+ * Find the failing cache lines of a block which raised an SError and add
+ * them to the error records. The block is first re-read in chunks of
+ * NVDIMM_ARS_BLOCK_SIZE so that only the chunks which fault are walked line
+ * by line. Return -1 if the error record buffer is full; restart_pa and
+ * restart_len then point to the first error which couldn't be recorded.
+ */
+static __always_inline inline
+int nvdimm_ars_locate(struct bf_ars *ars, uint64_t pa, uint64_t len)
+{
+	struct ars_err_rec *rec = ars->output.query.rec;
+	uint64_t end = pa + len, chunk, chunk_end, line;
+
+	pa &= ~((uint64_t)NVDIMM_ARS_CACHE_LINE_SIZE - 1);
+
+	for (chunk = pa; chunk < end; chunk = chunk_end) {
+		chunk_end = chunk + NVDIMM_ARS_BLOCK_SIZE;
+		if (chunk_end > end)
+			chunk_end = end;
+
+		ars->serror = 0;
+		nvdimm_ars_scrub(ars, chunk, chunk_end - chunk);
+		if (!ars->serror)
+			continue;
+
+		for (line = chunk; line < chunk_end;
+		     line += NVDIMM_ARS_CACHE_LINE_SIZE) {
+			uint32_t num = ars->output.query.num;
+
+			/*
+			 * Read the line again and wait for it with a full
+			 * memory fence, so that an SError, if any, is taken
+			 * before moving on to the next line.
+			 */
+			ars->serror = 0;
+			nvdimm_ars_scrub(ars, line, NVDIMM_ARS_CACHE_LINE_SIZE);
+			if (!ars->serror)
+				continue;
+
+			/* Merge into the last record, or create a new one. */
+			if (num && rec[num - 1].handle == ars->handle &&
+			    line == rec[num - 1].pa + rec[num - 1].len) {
+				rec[num - 1].len += NVDIMM_ARS_CACHE_LINE_SIZE;
+				continue;
+			}
+
+			if (num >= NVDIMM_ARS_REC_NUM) {
+				ars->output.query.flags |=
+						NVDIMM_ARS_FLAG_OVERFLOW;
+				if (line > ars->output.query.restart_pa) {
+					ars->output.query.restart_len -= line -
+						ars->output.query.restart_pa;
+					ars->output.query.restart_pa = line;
+				}
+				return -1;
+			}
+
+			NOTICE("Found memory error at address 0x%llx "
+				"during address range scrub.\n", line);
+			rec[num].handle = ars->handle;
+			rec[num].reserved = 0;
+			rec[num].pa = line;
+			rec[num].len = NVDIMM_ARS_CACHE_LINE_SIZE;
+			ars->output.query.num++;
+			ars->output.query.size += sizeof(struct ars_err_rec);
+		}
+	}
+
+	return 0;
+}
+
 /* NVDIMM ARS handler. */
 uint64_t nvdimm_ars_irq_handler(int irq, void *arg)
 {
@@ -870,6 +1027,7 @@ nvdimm_ars_irq_handler_begin:
 		ars->output.query.type = 0x2;
 		ars->output.query.flags = 0;
 		ars->output.query.num = 0;
+		ars->scrubbed = 0;
 		ars->output.query.size = (uintptr_t)ars->output.query.rec -
 					 (uintptr_t)&ars->output.query - 4;
 		ars->output.query.rec[0].len = 0;
@@ -884,9 +1042,7 @@ nvdimm_ars_irq_handler_begin:
 		}
 
 		/* Initiate the scrub. */
-		ars->serror = 0;
-		nvdimm_ars_scrub(ars, ars->output.query.restart_pa,
-				 NVDIMM_ARS_BLOCK_SIZE);
+		nvdimm_ars_start_block(ars);
 
 		/*
 		 * Enable the down-counter interrupt.
@@ -952,81 +1108,46 @@ nvdimm_dcnt0_irq_handler_begin:
 	if (ars->output.query.ext_status != ARS_EXT_STATUS_INPROGRESS)
 		return 0;
 
-	/* Fill in the error record if serror is found. */
-	if (ars->serror) {
-		uint64_t pa = ars->output.query.restart_pa;
-		struct ars_err_rec *rec = ars->output.query.rec;
-
-		/* Walk through each cacheline to find the error. */
-		for (pa = ars->output.query.restart_pa;
-		     pa < ars->output.query.restart_pa + NVDIMM_ARS_BLOCK_SIZE;
-		     pa += NVDIMM_ARS_CACHE_LINE_SIZE) {
-			int num = ars->output.query.num;
-
-			/* Stop if no more space for more error records. */
-			if (num >= NVDIMM_ARS_REC_NUM) {
-				nvdimm_ars_set_ext_status(
-					ars, ARS_EXT_STATUS_PRE_STOP);
-				return 0;
-			}
-
-			/*
-			 * How to tell a specific line has error?
-			 *
-			 * Here we read it again and use a full memory fence
-			 * to wait for it to finish. Needs to verify it on real
-			 * HW to see whether the SError can actually finish.
-			 * If not, other way should be investigated such as by
-			 * checking the return result with the assumption that
-			 * the Data Abort won't change the target register.
-			 */
-			ars->serror = 0;
-			__asm__ volatile("dsb st\n\t");
-			*(volatile uint64_t *)pa;
-			__asm__ volatile("dsb sy\n\t");
-			if (!ars->serror)
-				continue;
-
-			/* Merge into last record, or create a new one. */
-			if (rec[num].len && pa == rec[num].pa + rec[num].len &&
-			    rec[num].handle == ars->handle) {
-				rec[num].len += NVDIMM_ARS_CACHE_LINE_SIZE;
-			} else {
-				NOTICE("Found memory error at address 0x%llx "
-					"during address range scrub.\n", pa);
-				rec[num].handle = ars->handle;
-				rec[num].pa = pa;
-				rec[num].len = NVDIMM_ARS_CACHE_LINE_SIZE;
-				ars->output.query.num++;
-			}
-		}
+	/* Record the failing lines, keep going unless out of records. */
+	if (ars->serror &&
+	    nvdimm_ars_locate(ars, ars->output.query.restart_pa,
+			      nvdimm_ars_cur_len)) {
+		NOTICE("ARS error records full, stopped at 0x%llx.\n",
+		       ars->output.query.restart_pa);
+		nvdimm_ars_set_ext_status(ars, ARS_EXT_STATUS_PRE_STOP);
+		return 0;
 	}
+	ars->scrubbed += nvdimm_ars_cur_len;
 
-	if (ars->output.query.restart_len <= NVDIMM_ARS_BLOCK_SIZE) {
+	if (ars->output.query.restart_len <= nvdimm_ars_cur_len) {
 		/* All done. */
-		INFO("ARS done: start_pa=0x%llx, start_len=0x%llx\n",
-		     ars->start_pa, ars->start_len);
+		INFO("ARS done: start_pa=0x%llx, start_len=0x%llx, "
+		     "errors=%u\n", ars->start_pa, ars->start_len,
+		     ars->output.query.num);
 		nvdimm_ars_set_ext_status(ars, ARS_EXT_STATUS_COMPLETE);
 		return 0;
 	}
 
-	/* Start the next block. */
-	ars->serror = 0;
-	ars->output.query.restart_pa += NVDIMM_ARS_BLOCK_SIZE;
-	ars->output.query.restart_len -= NVDIMM_ARS_BLOCK_SIZE;
+	/*
+	 * Start the next block. restart_pa / restart_len always describe
+	 * what is left to do, so the OS can poll them (and 'scrubbed') for
+	 * progress with Query ARS Status.
+	 */
+	ars->output.query.restart_pa += nvdimm_ars_cur_len;
+	ars->output.query.restart_len -= nvdimm_ars_cur_len;
 
 	/* Only scrub NVDIMM regions. */
 	ars->handle = nvdimm_adjust_ars_range(&ars->output.query.restart_pa,
 					      &ars->output.query.restart_len);
 	if (ars->handle < 0 || ars->output.query.restart_len == 0) {
-		INFO("ARS done: start_pa=0x%llx, start_len=0x%llx\n",
-			ars->start_pa, ars->start_len);
+		INFO("ARS done: start_pa=0x%llx, start_len=0x%llx, "
+		     "errors=%u\n", ars->start_pa, ars->start_len,
+		     ars->output.query.num);
 		nvdimm_ars_set_ext_status(ars, ARS_EXT_STATUS_COMPLETE);
 		return 0;
 	}
 
-	nvdimm_ars_scrub(ars, ars->output.query.restart_pa,
-			 NVDIMM_ARS_BLOCK_SIZE);
+	nvdimm_ars_start_block(ars);
 
 	/* Re-enable the down-counter interrupt. */
 	mmio_write_64(RSHIM_BASE + RSH_DOWN_COUNT_VALUE__FIRST_WORD, dcnt.word);
@@ -1054,6 +1175,10 @@ void bluefield_init_efi_info(uintptr_t addr)
 		return;
 	}
 
+	/* Carry on with the boot log BL2 started. */
+	if (efi_info->boot_log)
+		bf_boot_log_attach(efi_info->boot_log);
+
 	/* Don't continue if we don't have at least one valid entry for both. */
 	if (!efi_info->region_num || !efi_info->nvdimm_num)
 		return;
@@ -1082,6 +1207,22 @@ void bluefield_init_efi_info(uintptr_t addr)
 		ERROR("NVDIMM unable to register the dcnt0 irq handler.\n");
 }
 
+/* Return a bitmap of the memory controllers BL2 found memory on. */
+uint32_t bluefield_efi_mss_mask(void)
+{
+	uint32_t mask = 0;
+
+	if (efi_info == NULL || memcmp(bf_efi_magic_number, efi_info->magic,
+				       sizeof(bf_efi_magic_number)))
+		return 0;
+
+	for (int i = 0; i < MAX_DIMM_NUM; i++)
+		if (efi_info->region[i].length)
+			mask |= 1 << (i / MAX_DIMM_PER_MEM_CTRL);
+
+	return mask;
+}
+
 #define RSH_PWR_WDOG_STATUS_CHECK(field, max_ms, err_msg) do { \
 	uint32_t ms = 0; \
 	RSH_PWR_WDOG_STATUS_t status; \
@@ -34,8 +34,12 @@
 #include <delay_timer.h>
 #include <mmio.h>
 #include <string.h>
+#include "bluefield_boot_trace.h"
 #include "bluefield_ddr.h"
 #include "bluefield_ddr_print.h"
+#include "bluefield_ddr_shadow.h"
+#include "bluefield_ddr_stats.h"
+#include "bluefield_ddr_train_cache.h"
 #include "bluefield_def.h"
 #include "emc.h"
 #include "emi.h"
@@ -56,8 +60,13 @@
 #define	PHY_RD_DEL		4
 #define PHY_WR_DEL		2
 
+#ifdef DDR_PARALLEL_SETUP
+/* The DDR parameters each core is currently setting up. */
+struct ddr_params *ddr_core_dp[PLATFORM_CORE_COUNT];
+#else
 /* The place where we store the DDR parameters for the current setup. */
-struct ddr_params *dp;
+struct ddr_params *ddr_cur_params;
+#endif
 /* Struct storing the ddr parameters. */
 struct ddr_params dps[MAX_MEM_CTRL];
 
@@ -171,6 +180,7 @@ int get_host_vrefdq_isel(int phy_rd_vref)
 
 static void dimm_reset(int reset_cmd)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int gpio_pin;
 
 	int mode0;
@@ -186,6 +196,9 @@ static void dimm_reset(int reset_cmd)
 	MEM_VERB("%setting DIMM at side %d\n", reset_cmd ? "S" : "Res",
 					       dp->mss_index);
 
+	/* The GPIO block is shared by both MSSes. */
+	ddr_engine_lock(DDR_ENGINE_LOCK_TYU);
+
 	mmio_write_32(TYU_BASE_ADDRESS + TYU_GPIO_LOCK,
 		      (0xd42f << TYU_GPIO_LOCK_SET_LOCK));
 
@@ -210,7 +223,7 @@ static void dimm_reset(int reset_cmd)
 		mode1 = mmio_read_32(TYU_BASE_ADDRESS + TYU_GPIO_GPIO0 +
 			     TYU_GPIO_GPIOX_MODE1_OFFSET);
 
-		tf_printf("Current mode0 = %d mode1 = %d\n", mode0, mode1);
+		MEM_VERB("Current mode0 = %d mode1 = %d\n", mode0, mode1);
 	}
 
 	functional_en0 = mmio_read_32(TYU_BASE_ADDRESS + TYU_GPIO_GPIO0 +
@@ -252,10 +265,12 @@ static void dimm_reset(int reset_cmd)
 			mmio_read_32(TYU_BASE_ADDRESS + TYU_GPIO_GPIO0 +
 				     TYU_GPIO_GPIOX_FUNCTIONAL_ENABLE1_OFFSET);
 
-		tf_printf("Current functional_en0 = %d functional_en1 = %d\n",
-			  functional_en0, functional_en1);
+		MEM_VERB("Current functional_en0 = %d functional_en1 = %d\n",
+			 functional_en0, functional_en1);
 	}
 
+	ddr_engine_unlock(DDR_ENGINE_LOCK_TYU);
+
 	mem_config_ndelay(1 * NS_PER_MS);
 }
 
@@ -390,6 +405,7 @@ static int calc_pll_params(uint64_t fout, uint64_t fin, uint32_t *core_f,
 
 static void ddr_set_dll_frequency(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t pll_bwadj;
 	uint32_t pll_cfg;
 	uint32_t core_f = 0;
@@ -594,6 +610,7 @@ static void ddr_set_dll_frequency(void)
 
 static void ddr_interface_freq_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t tyu_mss_rst;
 	uint32_t tyu_mss_rst_orig;
 	uint32_t rst_pin_s_umx;
@@ -612,6 +629,9 @@ static void ddr_interface_freq_setup(void)
 	/* @TODO a) Set the DDR DIMM's or SDRAM Systen Reset to be active. */
 	dimm_reset(0);
 
+	/* TYU_MSS_RESET holds the resets of both MSSes. */
+	ddr_engine_lock(DDR_ENGINE_LOCK_TYU);
+
 	/* b) Set the MSS EMI and DDR PHY Reset. */
 	tyu_mss_rst = mmio_read_32(TYU_BASE_ADDRESS + TYU_MSS_RESET);
 	tyu_mss_rst_orig = tyu_mss_rst;
@@ -632,6 +652,8 @@ static void ddr_interface_freq_setup(void)
 	tyu_mss_rst = (tyu_mss_rst & ~rst_pin_s_umx) |
 			(tyu_mss_rst_orig & rst_pin_s_umx);
 	mmio_write_32(TYU_BASE_ADDRESS + TYU_MSS_RESET, tyu_mss_rst);
+	ddr_engine_unlock(DDR_ENGINE_LOCK_TYU);
+	ddr_shadow_invalidate();
 	MEM_VERB("Release the MSS EMI and DDR PHY Reset.\n");
 	mem_config_ndelay(500);
 }
@@ -719,6 +741,7 @@ static void mem_interface_config(void)
 /* Setup the memory controller configuration registers. */
 static void mem_ctrl_config_regs(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	EMC_TIMING1_t et1 = { .word = emc_read(EMC_TIMING1) };
 	et1.wra_trp_gap = dp->cwl + dp->al + dp->mc_3ds_al_add + dp->pl +
 			  4 + DDR_CEIL_DIV(dp->twr + dp->trp, dp->tck);
@@ -994,6 +1017,7 @@ static void mem_ctrl_config_regs(void)
 /* Memory controller configuration. */
 static void mem_ctrl_config(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t tyu_mss_rst;
 	uint32_t rst_pin_umx;
 	uint32_t rst_pin_s;
@@ -1011,6 +1035,9 @@ static void mem_ctrl_config(void)
 		MEM_ERR("Unsupported MSS index %d.\n", dp->mss_index);
 		return;
 	}
+	/* TYU_MSS_RESET holds the resets of both MSSes. */
+	ddr_engine_lock(DDR_ENGINE_LOCK_TYU);
+
 	/* Set EMI Functional Reset. */
 	tyu_mss_rst = mmio_read_32(TYU_BASE_ADDRESS + TYU_MSS_RESET);
 	tyu_mss_rst |= rst_pin_s;
@@ -1020,6 +1047,7 @@ static void mem_ctrl_config(void)
 	/* Clear EMI Configuration Reset. */
 	tyu_mss_rst &= ~(rst_pin_g | rst_pin_umx);
 	mmio_write_32(TYU_BASE_ADDRESS + TYU_MSS_RESET, tyu_mss_rst);
+	ddr_shadow_invalidate();
 	MEM_VERB("Clear EMI Configuration Reset.\n");
 
 	/* Write Memory Controller Configuration registers. */
@@ -1029,12 +1057,15 @@ static void mem_ctrl_config(void)
 	/* Release EMI Functional Reset. */
 	tyu_mss_rst &= ~rst_pin_s;
 	mmio_write_32(TYU_BASE_ADDRESS + TYU_MSS_RESET, tyu_mss_rst);
+	ddr_engine_unlock(DDR_ENGINE_LOCK_TYU);
 	MEM_VERB("Released EMI Reset.\n");
 }
 
 /* Setup the values for the rcd_regs[] array. */
 static void rcd_reg_val_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	for (int i = 0; i < MAX_DIMM_PER_MEM_CTRL; i++) {
 
 		if (dp->dimm[i].ranks == 0)
@@ -1081,6 +1112,7 @@ static void rcd_reg_val_setup(void)
 		if (ddr_verbose_flag) {
 			int m = RCD_NUM % 2;
 
+			ddr_engine_lock(DDR_ENGINE_LOCK_CONSOLE);
 			tf_printf("Calculating RCD values for DIMM%d\n", i);
 			for (int j = 0; j < RCD_NUM / 2; j++)
 				tf_printf("RC0%x = 0x%x\tRC%xx = 0x%x\n", j,
@@ -1089,6 +1121,7 @@ static void rcd_reg_val_setup(void)
 			if (m)
 				tf_printf("RC0%x = 0x%x\n", RCD_NUM / 2,
 				  dp->dimm[i].rcd_regs[RCD_NUM / 2]);
+			ddr_engine_unlock(DDR_ENGINE_LOCK_CONSOLE);
 
 		}
 	}
@@ -1097,6 +1130,8 @@ static void rcd_reg_val_setup(void)
 /* Setup the values for the db_regs[] array. */
 static void db_reg_val_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	for (int i = 0; i < MAX_DIMM_PER_MEM_CTRL; i++) {
 
 		if (dp->dimm[i].ranks == 0)
@@ -1185,6 +1220,7 @@ static void db_reg_val_setup(void)
  */
 static int mr_reg_val_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	const uint8_t mr0_cl_lookup[] = {
 		[9] = 0,	[10] = 1,	[11] = 2,	[12] = 3,
 		[13] = 4,	[14] = 5,	[15] = 6,	[16] = 7,
@@ -1315,9 +1351,11 @@ static int mr_reg_val_setup(void)
 			   (mr6_tccd_l << 10);
 
 		if (ddr_verbose_flag) {
+			ddr_engine_lock(DDR_ENGINE_LOCK_CONSOLE);
 			tf_printf("Calculated MRS values for rank %d:\n", r);
 			for (int j = 0; j < 7; j++)
 				tf_printf("MR%d = 0x%x\n", j, MR(j, r));
+			ddr_engine_unlock(DDR_ENGINE_LOCK_CONSOLE);
 		}
 	}
 
@@ -1328,6 +1366,7 @@ static int mr_reg_val_setup(void)
 #pragma weak setup_ZQnPR
 void setup_ZQnPR(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t zq_ocdi = dp->phy_wr_drv == RZQ_DIV_4 ? 7 :
 			   dp->phy_wr_drv == RZQ_DIV_5 ? 9 :
 			   dp->phy_wr_drv == RZQ_DIV_6 ? 11 :
@@ -1363,6 +1402,7 @@ void setup_ZQnPR(void)
 /* DDR PHY SDRAM system specific registers configuration */
 static void ddr_phy_config(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	PUB_PGCR1_t pgcr1 = { .word = pub_read(PUB_PGCR1) };
 	pgcr1.updmstrc0 = 1;
 	pgcr1.prcfg_en = dp->dimm_num == 2;
@@ -1662,6 +1702,7 @@ static int ddr_phy_init(void)
 /* DDR PHY CK deferential pair signals delay setup. */
 static void ddr_phy_ck_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	PUB_ACMDLR0_t acmdlr0 = { .word = pub_read(PUB_ACMDLR0) };
 
 	/* Skip this part if all the clk delays are less than 15ps. */
@@ -1785,6 +1826,8 @@ static void dimm_system_release(void)
 /* RCD configuration sequence. */
 static void rcd_config_seq(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 #define RCD_W(reg, end)	\
 	do { \
 		mrs_write(mr, 7, RC ## reg + RC(reg, dimm_idx), 0, 0x10, end); \
@@ -1819,6 +1862,8 @@ static void rcd_config_seq(void)
 /* DB configuration sequence. */
 static void db_config_seq(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 #define DB_W(pfx, reg, val, end)	\
 	do { \
 		mrs_write(mr, 7, 0x1000 + pfx ## reg + val, 0, \
@@ -1853,6 +1898,8 @@ static void db_config_seq(void)
 /* DDR4 MRS initialization sequence. */
 static void mrs_config_seq(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 #define MRS_W(reg, end) \
 	do { \
 		mrs_write(mr, reg, MR(reg, i), 0, 4, end); \
@@ -1905,6 +1952,8 @@ static void mrs_config_seq(void)
 /* VREF static setup. */
 static void vref_static_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	for (int i = 0; i < MAX_ACTIVE_RANKS; i++) {
 		if ((dp->active_ranks & (1 << i)) == 0)
 			continue;
@@ -1941,6 +1990,7 @@ static void vref_static_setup(void)
 /* This function restores the Vref value of a rank to the average value */
 int vref_rank_avg_restore(int rank_idx)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t sdram_vref_range = dp->res_mr6_vref[rank_idx][0];
 	uint32_t sdram_vref_sum   = 0;
 	uint32_t sdram_vref_average;
@@ -1993,6 +2043,8 @@ int vref_rank_avg_restore(int rank_idx)
 /* DIMM's or SDRAM initialization. */
 static void dimm_init(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/* Activate CKE output. */
 	EMC_PHY_CTRL_t epc = {
 		.ck_en = (4 * ((1 << dp->dimm[1].ranks) - 1) +
@@ -2378,6 +2430,7 @@ static void ddr_phy_pre_buffer_addressability_bytes_enable_single(int en_byte)
 /* Internal sequence taken from mrep training function for less indenting. */
 static void lrdimm_db_mrep_training_internal_loop(int dimm, int rank, int *rval)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int dimm_db_rank = 2 * dimm;
 	int dram_rank = 2 * dimm + rank;
 	uint8_t mrep_result[BYTELANE_NUM][64] = {0};
@@ -2466,6 +2519,7 @@ static void lrdimm_db_mrep_training_internal_loop(int dimm, int rank, int *rval)
 
 static int lrdimm_db_mrep_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int rval = 0;
 
 	lrdimm_db_training_pre_condition(0);
@@ -2525,6 +2579,7 @@ static int lrdimm_db_mrep_training(void)
 /* Internal sequence taken from mrd training function for less indenting. */
 static void lrdimm_db_mrd_training_internal_loop(int dimm, int rank, int *rval)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	const int bccx_calc[5] = {0x6, 0x5, 0x0, 0x1, 0x2};
 
 	int dimm_db_rank = 2 * dimm;
@@ -2628,6 +2683,7 @@ static void lrdimm_db_mrd_training_internal_loop(int dimm, int rank, int *rval)
 
 static int lrdimm_db_mrd_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int rval = 1;
 
 	lrdimm_db_training_pre_condition(0);
@@ -2710,6 +2766,7 @@ static int lrdimm_db_mrd_training(void)
 /* Internal sequence taken from dwl training function for less indenting. */
 static void lrdimm_db_dwl_training_internal_loop(int dimm, int rank, int *rval)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int dimm_db_rank = 2 * dimm;
 	int dram_rank = 2 * dimm + rank;
 	uint8_t dwl_result[BYTELANE_NUM][64] = {0};
@@ -2788,6 +2845,7 @@ static void lrdimm_db_dwl_training_internal_loop(int dimm, int rank, int *rval)
 
 static int lrdimm_db_dwl_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int rval = 1;
 
 	lrdimm_db_training_pre_condition(0);
@@ -2820,6 +2878,7 @@ static int lrdimm_db_dwl_training(void)
 /* Internal sequence taken from mwd training function for less indenting. */
 static void lrdimm_db_mwd_training_internal_loop(int dimm, int rank, int *rval)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	const int bcdx_calc[5] = {0x6, 0x5, 0x0, 0x1, 0x2};
 
 	int dimm_db_rank = 2 * dimm;
@@ -2958,6 +3017,7 @@ static void lrdimm_db_mwd_training_internal_loop(int dimm, int rank, int *rval)
 
 static int lrdimm_db_mwd_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int rval = 1;
 	uint64_t rand_state = 4;
 
@@ -3069,6 +3129,7 @@ static int lrdimm_db_data_training(void)
 /* Also called the LRDIMM DDR PHY HWL Training flow. */
 static int lrdimm_standalone_write_leveling(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int rval = 1;
 	PUB_DTCR1_t dtcr1 = { .word = pub_read(PUB_DTCR1) };
 	PUB_DTCR1_t dtcr1_temp = dtcr1;
@@ -3155,6 +3216,7 @@ static int lrdimm_standalone_write_leveling(void)
 /* Also called the LRDIMM DDR PHY HIR Training flow. */
 static int lrdimm_standalone_dqs_gate_leveling(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int rval = 1;
 	PUB_DTCR1_t dtcr1_orig = { .word = pub_read(PUB_DTCR1) };
 
@@ -3272,6 +3334,8 @@ static int lrdimm_standalone_dqs_gate_leveling(void)
  */
 int ddr_phy_data_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	if (dp->type == LRDIMM) {
 		if (!lrdimm_db_data_training()) {
 			MEM_ERR("LRDIMM data buffer training failed.\n");
@@ -3348,6 +3412,7 @@ static int ddr_phy_vref_training(void)
  */
 static void vref_host_training_min_max_check(int rank, int byte)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	PUB_DXnGCR5_t dxngcr5 = { .word = pub_read(ADDR_DXn(GCR5, byte)) };
 	dp->res_dxngcr5[rank][byte] = GET_RANK_FIELD(dxngcr5, dxrefiselr, rank);
 
@@ -3425,6 +3490,7 @@ static void vref_host_training_min_max_check(int rank, int byte)
  */
 static int vref_sdram_training_dqres2_disabled(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t vrefdq_tr_val;
 
 	mr6_get_vrefdq(dp->mem_vref, &vrefdq_tr_val, NULL);
@@ -3488,6 +3554,7 @@ static uint32_t get_pub_vtdr_dvrefmx(void)
  */
 static int vref_sdram_training_dqres2_enabled_min_max(int is_min)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t mr6_temp;
 	uint32_t vrefdq_tr_val;
 	/*
@@ -3573,6 +3640,7 @@ static void vref_min_max_2_mean(uint32_t min_idx, uint32_t max_idx, int rank,
 				int byte, uint32_t *vref_range,
 				uint32_t *vref_index)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t sdram_vref = (mr6_get_vrefdq_r2_inv(min_idx) +
 			       mr6_get_vrefdq_r1_inv(max_idx)) / 2;
 
@@ -3596,6 +3664,8 @@ static void vref_min_max_2_mean(uint32_t min_idx, uint32_t max_idx, int rank,
  */
 static int vref_sdram_training_dqres2_enabled(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/* Seek out the vref sdram min values. */
 	if (!vref_sdram_training_dqres2_enabled_min_max(1))
 		return 0;
@@ -3648,6 +3718,7 @@ static int per_dram_addr_vref_setup_internal(int phy_rank, int byte,
 					     uint32_t pda_dq,
 					     uint32_t new_mr6_vref)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t mr6_vref_set, mr6_vref_unset, schcr0, schcr1;
 
 	mr6_vref_set = (MR(6, 0) & 0xff00) | 0x80 | new_mr6_vref;
@@ -3696,6 +3767,7 @@ static int per_dram_addr_vref_setup_internal(int phy_rank, int byte,
  */
 int per_dram_addressability_vref_setup(int rank)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int phy_rank = 4 * rank;
 	uint32_t tmp_mr3_data = MR(3, 0) | 0x0010;
 	uint32_t schcr1 = (phy_rank << 28) | (tmp_mr3_data << 8) | 0x30;
@@ -3786,12 +3858,50 @@ int per_dram_addressability_vref_setup(int rank)
 	return 1;
 }
 
+/*
+ * Program the SDRAM VREF results (either just trained or restored from the
+ * training cache) into the DDR PHY and the SDRAMs.
+ * Return 1 on success or 0 if failed.
+ */
+static int vref_sdram_apply(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+
+	/* c)80 Write the MR6_DATA value to MR6 of all populated ranks. */
+	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
+
+		if ((dp->active_ranks & (1 << rank)) == 0)
+			continue;
+
+		pub_switch_rankidr(rank, 1, 1);
+		pub_write(PUB_MR6, MR(6, rank));
+	}
+
+	/* Skip the follow steps if both pdaen and dqres2 are disabled. */
+	if (!dp->vref_train_pdaen && !dp->vref_train_dqres2)
+		return 1;
+
+	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
+		if ((dp->active_ranks & (1 << rank)) == 0)
+			continue;
+		if (!per_dram_addressability_vref_setup(rank)) {
+			MEM_ERR("Per DRAM Addressability VREF setup failed.\n");
+			return 0;
+		}
+	}
+	pub_write(PUB_SCHCR0, 0);
+	pub_write(PUB_SCHCR1, 0);
+	return 1;
+}
+
 /*
  * DDR PHY and DIMM's SDRAM Device VREF Training when VREF_TRAIN_BYPASS is
  * disabled. Returns 1 on success or 0 if failed.
  */
 int ddr_phy_dimm_sdram_vref_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	/*
 	 * Initialize the VREF Training Setup for the DDR PHY BIST and the VREF
 	 * Training Control registers.
@@ -3858,31 +3968,7 @@ int ddr_phy_dimm_sdram_vref_training(void)
 		}
 	}
 
-	/* c)80 Write the MR6_DATA value to MR6 of all populated ranks. */
-	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
-
-		if ((dp->active_ranks & (1 << rank)) == 0)
-			continue;
-
-		pub_switch_rankidr(rank, 1, 1);
-		pub_write(PUB_MR6, MR(6, rank));
-	}
-
-	/* Skip the follow steps if both pdaen and dqres2 are disabled. */
-	if (!dp->vref_train_pdaen && !dp->vref_train_dqres2)
-		return 1;
-
-	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
-		if ((dp->active_ranks & (1 << rank)) == 0)
-			continue;
-		if (!per_dram_addressability_vref_setup(rank)) {
-			MEM_ERR("Per DRAM Addressability VREF setup failed.\n");
-			return 0;
-		}
-	}
-	pub_write(PUB_SCHCR0, 0);
-	pub_write(PUB_SCHCR1, 0);
-	return 1;
+	return vref_sdram_apply();
 }
 
 /*
@@ -3892,6 +3978,7 @@ int ddr_phy_dimm_sdram_vref_training(void)
  */
 int pdpdtc_internal_loop(int rank, int byte)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int byte_nom_err = 0;
 	uint32_t b_iprd, b_wlsl, b_wld, b_dgsl, b_dqsgd;
 	PUB_DXnMDLR0_t dxnmdlr0;
@@ -4000,6 +4087,7 @@ int pdpdtc_internal_loop(int rank, int byte)
  */
 int post_ddr_phy_data_training_configs(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	int byte_nom_err = 0;
 
 	if (dp->wlrdqsg_lcdl_norm == 0) {
@@ -4035,6 +4123,7 @@ int post_ddr_phy_data_training_configs(void)
  */
 int test_write_readback(uint64_t *rand_state, uint32_t rank)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t read_data[EMI_IND_DATA__LENGTH];
 	uint32_t write_data[EMI_IND_DATA__LENGTH];
 
@@ -4088,6 +4177,7 @@ int test_write_readback(uint64_t *rand_state, uint32_t rank)
  */
 int mc_latency_post_ddr_phy_data_training(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint64_t rand_state = 3;
 	uint32_t latency = 10;
 	EMC_EXT_MC_LATENCY_t eeml = {
@@ -4141,9 +4231,46 @@ int mc_latency_post_ddr_phy_data_training(void)
 	return latency < 0x3f;
 }
 
+/*
+ * Check the DDR PHY state restored from the training cache with a few
+ * writes and readbacks on every rank, at the read latency the MSS was
+ * trained with. Returns 1 if they all succeed, else 0.
+ */
+static int verify_cached_training(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	uint64_t rand_state = 3;
+	int ret = 1;
+
+	EMC_MC_DDR_IF_t emdi = { .word = emc_read(EMC_MC_DDR_IF) };
+	emdi.mc_en = 1;
+	emc_write(EMC_MC_DDR_IF, emdi.word);
+
+	for (int rank = 0; rank < MAX_ACTIVE_RANKS && ret; rank++) {
+		if ((dp->active_ranks & (1 << rank)) == 0)
+			continue;
+		/* Clear the Memory Controller Read Data FIFO path. */
+		MC_PUP_CTRL_t mpc = { .mc_sw_rd_rst = 1 };
+		pub_indirect_write(MC_PUP_CTRL, mpc.word);
+		mem_config_ndelay(1000);
+		mpc.mc_sw_rd_rst = 0;
+		pub_indirect_write(MC_PUP_CTRL, mpc.word);
+		mem_config_ndelay(1000);
+
+		for (int i = 0; i < 4 && ret; i++)
+			ret = test_write_readback(&rand_state, rank);
+	}
+
+	emdi.mc_en = 0;
+	emc_write(EMC_MC_DDR_IF, emdi.word);
+
+	return ret;
+}
+
 /* This step should be performed only when CRC_EN option is enabled. */
 static void enable_crc(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	EMC_DDR_DEBUG_t edd = { .word = emc_read(EMC_DDR_DEBUG) };
 	edd.crc_en = dp->crc_en;
 	emc_write(EMC_DDR_DEBUG, edd.word);
@@ -4184,56 +4311,91 @@ static void ddr_mc_enable(void)
 }
 
 /*
- * The actual steps for setup.
+ * Record the start of a step of the sequence for the boot time trace and
+ * the register access profile.
+ */
+#define DDR_TS_STEP(step) do {						\
+	bf_boot_ts_record(BF_TS_DDR_STEP(dp->mss_index, (step)));	\
+	ddr_stats_step(step);						\
+} while (0)
+
+/*
+ * The actual steps for setup. If cached is set, the training steps are
+ * replaced by restoring the results from the training cache.
  * Return 1 on success or 0 if failed.
  */
-int ddr_do_actual_setup(void)
+static int ddr_do_setup_steps(int cached)
 {
-	if (dp->dimm_num == 0)
-		return 0;
+	struct ddr_params *dp = ddr_cur_dp();
 
-	/* Also initialize some global variables here. */
-	dp->active_ranks = ((1 << dp->dimm[0].ranks) - 1) |
-			   (((1 << dp->dimm[1].ranks) - 1) << 2);
 	rcd_reg_val_setup();
 	if (dp->type == LRDIMM) {
 		db_reg_val_setup();
 	}
+	DDR_TS_STEP(0);
 	if (!mr_reg_val_setup()) {
 		MEM_ERR("MR compute fail, abort memory controller %d setup\n",
 			dp->mss_index);
 		return 0;
 	}
+	if (cached)
+		ddr_train_cache_restore_mr();
 
 	MEM_LOG("# Step 1: Set DDR Interface Frequency.\n");
+	DDR_TS_STEP(1);
 	ddr_interface_freq_setup();
 
 	MEM_LOG("# Step 2: Write Memory Controller Configuration registers.\n");
+	DDR_TS_STEP(2);
 	mem_ctrl_config();
 
 	MEM_LOG("# Step 3: APB Interface setup and clock & reset release.\n");
+	DDR_TS_STEP(3);
 	if (!apb_setup()) {
 		MEM_ERR("EMC APB interface not setup correctly!\n");
 		return 0;
 	}
 	MEM_LOG("# Step 4: DDR PHY SDRAM System Specific registers config.\n");
+	DDR_TS_STEP(4);
 	ddr_phy_config();
 
 	MEM_LOG("# Step 5: DDR PHY Initialization.\n");
+	DDR_TS_STEP(5);
 	if (!ddr_phy_init()) {
 		MEM_ERR("DDR PHY initialization failed!\n");
 		return 0;
 	}
 	MEM_LOG("# Step 6: DDR PHY CK deferential pair signals delay setup.\n");
+	DDR_TS_STEP(6);
 	ddr_phy_ck_setup();
 
 	MEM_LOG("# Step 7: DIMM's or SDRAM System Reset Release.\n");
+	DDR_TS_STEP(7);
 	dimm_system_release();
 
 	MEM_LOG("# Step 8: DIMM's or SDRAM Initialization.\n");
+	DDR_TS_STEP(8);
 	dimm_init();
 
+	if (cached) {
+		MEM_LOG("# Step 9-11: Restore cached DDR PHY training.\n");
+		DDR_TS_STEP(9);
+		if (!ddr_train_cache_restore_phy())
+			return 0;
+		if (!dp->vref_train_bypass && dp->vref_train_mem_en &&
+		    !vref_sdram_apply()) {
+			MEM_ERR("Restoring SDRAM VREF failed!\n");
+			return 0;
+		}
+		if (!verify_cached_training()) {
+			MEM_LOG("Cached DDR PHY training doesn't work.\n");
+			return 0;
+		}
+		goto trained;
+	}
+
 	MEM_LOG("# Step 9: DDR PHY Data Training.\n");
+	DDR_TS_STEP(9);
 	if (!ddr_phy_data_training()) {
 		MEM_ERR("DDR PHY data training failed!\n");
 		return 0;
@@ -4241,39 +4403,84 @@ int ddr_do_actual_setup(void)
 
 	if (!dp->vref_train_bypass && dp->type != LRDIMM) {
 		MEM_LOG("# Step 10: DDR PHY and DIMM's SDRAM VREF training.\n");
+		DDR_TS_STEP(10);
 		if (!ddr_phy_dimm_sdram_vref_training()) {
 			MEM_ERR("DDR PHY & DIMM's SDRAM VREF training fail\n");
 			return 0;
 		}
 	} else if (dp->type == LRDIMM) {
 		MEM_LOG("# Step 10: LRDIMM DDR PHY & DB Int VREF Training.\n");
+		DDR_TS_STEP(10);
 		/* @TODO Implement LRDIMM DDR PHY & DB Interfrace VREF train. */
 	}
 
 	MEM_LOG("# Step 11: Post DDR PHY Data Training required configs.\n");
+	DDR_TS_STEP(11);
 	if (!post_ddr_phy_data_training_configs()) {
 		MEM_ERR("Post DDR PHY Data Training required config fail!\n");
 		return 0;
 	}
 
+trained:
 	MEM_LOG("# Step 12: Memory Controller Post DDR PHY Data Training.\n");
+	DDR_TS_STEP(12);
 	if (!mc_latency_post_ddr_phy_data_training()) {
 		MEM_ERR("Memory controller post DDR PHY data training fail!\n");
 		return 0;
 	}
 	if (dp->crc_en) {
 		MEM_LOG("# Step 13: Enable CRC operation.\n");
+		DDR_TS_STEP(13);
 		enable_crc();
 	}
 
 	MEM_LOG("# Step 14: Enable DDR Memory Controller operation.\n");
+	DDR_TS_STEP(14);
 	ddr_mc_enable();
 
+	ddr_train_cache_save();
+
+	DDR_TS_STEP(BF_TS_DDR_STEP_DONE);
 	return 1;
 }
 
+/*
+ * Setup the current MSS, using the training results of a previous boot
+ * when we have them for the same DIMMs, else training it from scratch.
+ * Return 1 on success or 0 if failed.
+ */
+int ddr_do_actual_setup(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	int ret;
+
+	if (dp->dimm_num == 0)
+		return 0;
+
+	/* Also initialize some global variables here. */
+	dp->active_ranks = ((1 << dp->dimm[0].ranks) - 1) |
+			   (((1 << dp->dimm[1].ranks) - 1) << 2);
+
+	if (ddr_train_cache_lookup()) {
+		if (ddr_do_setup_steps(1)) {
+			ddr_stats_print();
+			return 1;
+		}
+
+		MEM_LOG("Cached training results for MSS%d failed, "
+			"retraining.\n", dp->mss_index);
+		ddr_train_cache_invalidate();
+	}
+
+	ret = ddr_do_setup_steps(0);
+	ddr_stats_print();
+
+	return ret;
+}
+
 static void ddr_idle_interface_freq_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
 	uint32_t tyu_mss_rst;
 	uint32_t tyu_mss_rst_orig;
 	uint32_t rst_pin_umx;
@@ -4292,6 +4499,9 @@ static void ddr_idle_interface_freq_setup(void)
 		MEM_ERR("Unsupported MSS index %d.\n", dp->mss_index);
 		return;
 	}
+	/* TYU_MSS_RESET holds the resets of both MSSes. */
+	ddr_engine_lock(DDR_ENGINE_LOCK_TYU);
+
 	/* a) Set the MSS EMI and DDR PHY Reset. */
 	tyu_mss_rst = mmio_read_32(TYU_BASE_ADDRESS + TYU_MSS_RESET);
 	tyu_mss_rst_orig = tyu_mss_rst;
@@ -4313,6 +4523,8 @@ static void ddr_idle_interface_freq_setup(void)
 	mmio_write_32(TYU_BASE_ADDRESS + TYU_MSS_RESET, tyu_mss_rst);
 	tyu_mss_rst &= ~(rst_pin_g | rst_pin_umx);
 	mmio_write_32(TYU_BASE_ADDRESS + TYU_MSS_RESET, tyu_mss_rst);
+	ddr_engine_unlock(DDR_ENGINE_LOCK_TYU);
+	ddr_shadow_invalidate();
 	MEM_VERB("Release the MSS EMI and DDR PHY Reset.\n");
 	mem_config_ndelay(500);
 }
@@ -4323,6 +4535,8 @@ static void ddr_idle_interface_freq_setup(void)
  */
 int ddr_do_idle_setup(void)
 {
+	struct ddr_params *dp = ddr_cur_dp();
+
 	NOTICE("Doing MSS idle operations on MSS %d\n", dp->mss_index);
 
 	dp->tck = 1250000; /* Setup the PLL using lowest support frequency. */
@@ -4436,8 +4650,10 @@ int ddr_do_idle_setup(void)
 
 struct ddr_params *bluefield_setup_mss(uintptr_t mss_addr, int mem_ctrl_num)
 {
+	struct ddr_params *dp = &(dps[mem_ctrl_num]);
+
 	NOTICE("Initializing DDR at mss[%d]=0x%lx\n", mem_ctrl_num, mss_addr);
-	dp = &(dps[mem_ctrl_num]);
+	ddr_set_cur_dp(dp);
 	if (!ddr_get_info(dp, mss_addr, mem_ctrl_num)) {
 		MEM_ERR("DDR Values not valid!\n");
 		return NULL;
@@ -4449,6 +4665,14 @@ struct ddr_params *bluefield_setup_mss(uintptr_t mss_addr, int mem_ctrl_num)
 		return 0;
 	}
 
+	/*
+	 * When a DDR engine is available the actual setup runs on it, in
+	 * parallel with the other MSSes, and ddr_engine_run() reports how
+	 * it went.
+	 */
+	if (ddr_engine_queue(dp))
+		return dp;
+
 	if (!ddr_do_actual_setup()) {
 		MEM_ERR("Initializing DDR on MSS %d failed!\n", mem_ctrl_num);
 		return NULL;
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "bluefield_ddr.h"
+#include "bluefield_ddr_shadow.h"
+#include "emc.h"
+#include "emi.h"
+#include "pub.h"
+
+/* Entry key: valid bit, register type, rank (per rank PUB registers), id. */
+#define SHADOW_VALID		(1u << 31)
+#define SHADOW_KEY(type, rank, reg_id)	\
+	(SHADOW_VALID | ((type) << 24) | ((rank) << 16) | (reg_id))
+
+#define DX_STRIDE		(PUB_DX1GCR0 - PUB_DX0GCR0)
+
+struct ddr_shadow_entry {
+	uint32_t key;
+	uint32_t val;
+};
+
+struct ddr_shadow {
+	/* Direct mapped, write-through shadow of the register values. */
+	struct ddr_shadow_entry entry[DDR_SHADOW_ENTRIES];
+	/* Last value written to RANKIDR, which selects the per rank regs. */
+	uint32_t rankidr;
+	uint8_t rankidr_valid;
+	/* PGCR6.INHVT was last written as 1. */
+	uint8_t vt_inhibited;
+	/* Set while polling registers, which must come from the HW. */
+	uint8_t bypass;
+};
+
+/* Each MSS has its own shadow, so the engines never share an entry. */
+static struct ddr_shadow ddr_shadows[MAX_MEM_CTRL];
+
+static struct ddr_shadow *cur_shadow(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+
+	return &ddr_shadows[dp->mss_index];
+}
+
+/*
+ * PUB registers which are commands or get updated by the PHY without any
+ * explicit invalidation point (periodic ZQ calibration, DCU accesses).
+ */
+static int pub_reg_volatile(uint32_t reg_id)
+{
+	switch (reg_id) {
+	case PUB_RIDR:
+	case PUB_PIR:
+	case PUB_PGSR0:
+	case PUB_PGSR1:
+	case PUB_SCHCR0:
+	case PUB_BISTRR:
+	case PUB_DCUAR:
+	case PUB_DCUDR:
+	case PUB_DCURR:
+	case PUB_ZQCR:
+		return 1;
+	}
+
+	/* Of the ZQ registers only the ZQnPR are plain configuration. */
+	if (reg_id >= PUB_ZQ0PR && reg_id <= PUB_ZQ3SR)
+		return (reg_id - PUB_ZQ0PR) % (PUB_ZQ1PR - PUB_ZQ0PR) != 0;
+
+	return 0;
+}
+
+/* Delay line registers, which VT compensation keeps updating. */
+static int pub_reg_vt(uint32_t reg_id)
+{
+	if (reg_id >= PUB_ACBDLR0 && reg_id <= PUB_ACMDLR1)
+		return 1;
+
+	if (reg_id >= PUB_DX0GCR0 && reg_id < PUB_DX0GCR0 + 9 * DX_STRIDE)
+		return (reg_id - PUB_DX0GCR0) % DX_STRIDE >=
+		       PUB_DX0BDLR0 - PUB_DX0GCR0;
+
+	return 0;
+}
+
+/* Registers accessed through RANKIDR, see pub_rank_record[]. */
+static int pub_reg_per_rank(uint32_t reg_id)
+{
+	uint32_t reg0;
+
+	if (reg_id == PUB_ODTCR)
+		return 1;
+
+	if (reg_id < PUB_DX0GCR0 || reg_id >= PUB_DX0GCR0 + 9 * DX_STRIDE)
+		return 0;
+
+	/* The equivalent register of byte lane 0. */
+	reg0 = PUB_DX0GCR0 + (reg_id - PUB_DX0GCR0) % DX_STRIDE;
+
+	return (reg0 >= PUB_DX0LCDLR0 && reg0 <= PUB_DX0LCDLR5) ||
+	       reg0 == PUB_DX0GTR0;
+}
+
+/*
+ * Return the shadow key of a register access, or 0 if the register has to
+ * be accessed in HW.
+ */
+static uint32_t shadow_key(struct ddr_shadow *s, int type, uint32_t reg_id,
+			   int is_write)
+{
+	uint32_t rank = 0;
+
+	switch (type) {
+	case EMC_REG:
+		/*
+		 * EMC and EMI hold counters and status which software clears
+		 * by writing them, so only the addresses of the indirect
+		 * accesses are shadowed, to skip rewriting them.
+		 */
+		if (reg_id != EMC_IND_ADDR)
+			return 0;
+		break;
+	case EMI_REG:
+		if (reg_id != EMI_IND_ADDR)
+			return 0;
+		break;
+	case PUB_REG:
+		if (pub_reg_volatile(reg_id) ||
+		    (pub_reg_vt(reg_id) && !s->vt_inhibited))
+			return 0;
+		if (pub_reg_per_rank(reg_id)) {
+			PUB_RANKIDR_t rankidr = { .word = s->rankidr };
+
+			if (!s->rankidr_valid)
+				return 0;
+			rank = is_write ? rankidr.rankwid : rankidr.rankrid;
+		}
+		break;
+	default:
+		return 0;
+	}
+
+	return SHADOW_KEY((uint32_t)type, rank, reg_id);
+}
+
+static struct ddr_shadow_entry *shadow_entry(struct ddr_shadow *s,
+					     uint32_t key)
+{
+	return &s->entry[(key * 2654435761u) >> (32 - DDR_SHADOW_BITS)];
+}
+
+/*
+ * Look up a register in the shadow.
+ * Returns 1 and sets *data if the value is known, or 0 if the register has
+ * to be read from HW.
+ */
+int ddr_shadow_read(int type, uint32_t reg_id, uint32_t *data)
+{
+	struct ddr_shadow *s = cur_shadow();
+	struct ddr_shadow_entry *e;
+	uint32_t key;
+
+	if (s->bypass)
+		return 0;
+
+	if (type == PUB_REG && reg_id == PUB_RANKIDR) {
+		if (!s->rankidr_valid)
+			return 0;
+		*data = s->rankidr;
+		return 1;
+	}
+
+	key = shadow_key(s, type, reg_id, 0);
+	if (!key)
+		return 0;
+
+	e = shadow_entry(s, key);
+	if (e->key != key)
+		return 0;
+
+	*data = e->val;
+	return 1;
+}
+
+/*
+ * Record a register write in the shadow.
+ * Returns 1 if the register already holds this value and the write to HW
+ * can be skipped, or 0 if the write has to be done.
+ */
+int ddr_shadow_write(int type, uint32_t reg_id, uint32_t data)
+{
+	struct ddr_shadow *s = cur_shadow();
+	struct ddr_shadow_entry *e;
+	uint32_t key;
+
+	switch (type) {
+	case PUB_REG:
+		if (reg_id == PUB_RANKIDR) {
+			if (s->rankidr_valid && s->rankidr == data)
+				return 1;
+			s->rankidr = data;
+			s->rankidr_valid = 1;
+			return 0;
+		}
+
+		/* Training, scheduler and BIST commands run on the PHY. */
+		if (reg_id == PUB_PIR || reg_id == PUB_SCHCR0 ||
+		    reg_id == PUB_BISTRR) {
+			ddr_shadow_invalidate();
+			return 0;
+		}
+
+		if (reg_id == PUB_PGCR6) {
+			PUB_PGCR6_t pgcr6 = { .word = data };
+
+			/* The delay lines will change again from now on. */
+			if (s->vt_inhibited && !pgcr6.inhvt)
+				ddr_shadow_invalidate();
+			s->vt_inhibited = pgcr6.inhvt;
+		}
+		break;
+	case PUB_INDIRECT_REG:
+		/* PHY resets and other PHY control operations. */
+		ddr_shadow_invalidate();
+		return 0;
+	case EMC_REG:
+		/* Indirect operations on anything but the MC or its SRAM. */
+		if (reg_id == EMC_IND_CMD) {
+			EMC_IND_CMD_t cmd = { .word = data };
+
+			if (cmd.mem_id != EMC_IND_CMD__MEM_ID_VAL_MC &&
+			    cmd.mem_id != EMC_IND_CMD__MEM_ID_VAL_IFC)
+				ddr_shadow_invalidate();
+			return 0;
+		}
+		break;
+	default:
+		break;
+	}
+
+	key = shadow_key(s, type, reg_id, 1);
+	if (!key)
+		return 0;
+
+	e = shadow_entry(s, key);
+	if (e->key == key && e->val == data)
+		return 1;
+
+	e->key = key;
+	e->val = data;
+	return 0;
+}
+
+/* Forget everything known about the registers of the current MSS. */
+void ddr_shadow_invalidate(void)
+{
+	struct ddr_shadow *s = cur_shadow();
+
+	memset(s->entry, 0, sizeof(s->entry));
+	s->rankidr_valid = 0;
+	s->vt_inhibited = 0;
+}
+
+/* While set, ddr_shadow_read() always misses so polling sees the HW. */
+void ddr_shadow_bypass(int bypass)
+{
+	cur_shadow()->bypass = bypass;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "bluefield_boot_trace.h"
+#include "bluefield_ddr.h"
+#include "bluefield_ddr_stats.h"
+
+/* The steps are the ones of the boot time trace. */
+#define DDR_STATS_STEP_NUM	BF_TS_DDR_STEP_NUM
+
+struct ddr_access_stats {
+	uint32_t mmio_wr;	/* MSS register writes. */
+	uint32_t mmio_rd;	/* MSS register reads. */
+	uint32_t pub_wr;	/* PUB register writes requested. */
+	uint32_t pub_rd;	/* PUB register reads requested. */
+	uint32_t polls;		/* read_loop() calls. */
+	uint32_t retries;	/* Reads which didn't match while polling. */
+	uint64_t delay_ns;	/* Time requested with mem_config_ndelay(). */
+};
+
+static struct ddr_access_stats ddr_stats[MAX_MEM_CTRL][DDR_STATS_STEP_NUM];
+static uint8_t ddr_stats_cur[MAX_MEM_CTRL];
+
+static struct ddr_access_stats *cur_stats(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+
+	/* The Palladium tables also go through mem_config_read/write(). */
+	if (dp == NULL)
+		return NULL;
+
+	return &ddr_stats[dp->mss_index][ddr_stats_cur[dp->mss_index]];
+}
+
+/* Account the following accesses to <step>; step 0 restarts the profile. */
+void ddr_stats_step(unsigned int step)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+
+	if (step >= DDR_STATS_STEP_NUM)
+		step = DDR_STATS_STEP_NUM - 1;
+
+	if (step == 0)
+		memset(ddr_stats[dp->mss_index], 0,
+		       sizeof(ddr_stats[dp->mss_index]));
+
+	ddr_stats_cur[dp->mss_index] = step;
+}
+
+void ddr_stats_mmio(int is_write)
+{
+	struct ddr_access_stats *st = cur_stats();
+
+	if (st == NULL)
+		return;
+
+	if (is_write)
+		st->mmio_wr++;
+	else
+		st->mmio_rd++;
+}
+
+void ddr_stats_pub(int is_write)
+{
+	struct ddr_access_stats *st = cur_stats();
+
+	if (st == NULL)
+		return;
+
+	if (is_write)
+		st->pub_wr++;
+	else
+		st->pub_rd++;
+}
+
+void ddr_stats_poll(uint32_t retries)
+{
+	struct ddr_access_stats *st = cur_stats();
+
+	if (st == NULL)
+		return;
+
+	st->polls++;
+	st->retries += retries;
+}
+
+void ddr_stats_delay(uint32_t ns)
+{
+	struct ddr_access_stats *st = cur_stats();
+
+	if (st == NULL)
+		return;
+
+	st->delay_ns += ns;
+}
+
+/* Print the profile of the current MSS, one line per step. */
+void ddr_stats_print(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	struct ddr_access_stats *st = ddr_stats[dp->mss_index];
+	struct ddr_access_stats total;
+	int step;
+
+	memset(&total, 0, sizeof(total));
+
+	ddr_engine_lock(DDR_ENGINE_LOCK_CONSOLE);
+	printf("MSS%d register access profile:\n", dp->mss_index);
+	printf("step   mmio_wr   mmio_rd    pub_wr    pub_rd   polls "
+	       "retries   delay_us\n");
+	for (step = 0; step < DDR_STATS_STEP_NUM; step++, st++) {
+		if (!st->mmio_wr && !st->mmio_rd && !st->delay_ns)
+			continue;
+
+		printf("%4d %9u %9u %9u %9u %7u %7u %10llu\n", step,
+		       st->mmio_wr, st->mmio_rd, st->pub_wr, st->pub_rd,
+		       st->polls, st->retries, st->delay_ns / NS_PER_US);
+
+		total.mmio_wr += st->mmio_wr;
+		total.mmio_rd += st->mmio_rd;
+		total.pub_wr += st->pub_wr;
+		total.pub_rd += st->pub_rd;
+		total.polls += st->polls;
+		total.retries += st->retries;
+		total.delay_ns += st->delay_ns;
+	}
+	printf("all  %9u %9u %9u %9u %7u %7u %10llu\n",
+	       total.mmio_wr, total.mmio_rd, total.pub_wr, total.pub_rd,
+	       total.polls, total.retries, total.delay_ns / NS_PER_US);
+	ddr_engine_unlock(DDR_ENGINE_LOCK_CONSOLE);
+}
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <arch_helpers.h>
+#include <cassert.h>
+#include <debug.h>
+#include <string.h>
+#include "bluefield_ddr.h"
+#include "bluefield_ddr_train_cache.h"
+#include "emc.h"
+#include "pub.h"
+
+/* Nothing the boot images use may overlap the cache. */
+CASSERT(BL31_BASE > BL2_LIMIT, assert_ddr_train_cache_not_empty);
+CASSERT(DDR_TRAIN_CACHE_BASE >= BL2_LIMIT,
+	assert_ddr_train_cache_above_bl2);
+CASSERT(DDR_TRAIN_CACHE_BASE + DDR_TRAIN_CACHE_SIZE <= BL31_BASE,
+	assert_ddr_train_cache_below_bl31);
+CASSERT(DDR_TRAIN_CACHE_BASE + DDR_TRAIN_CACHE_SIZE <= BL1_RW_BASE ||
+	DDR_TRAIN_CACHE_BASE >= BL1_RW_LIMIT,
+	assert_ddr_train_cache_outside_bl1_rw);
+CASSERT(sizeof(struct ddr_train_cache_entry) * MAX_MEM_CTRL <=
+	DDR_TRAIN_CACHE_SIZE, assert_ddr_train_cache_size);
+CASSERT((sizeof(struct ddr_train_cache_entry) % sizeof(uint32_t)) == 0,
+	assert_ddr_train_cache_entry_align);
+
+/* Offsets of the DXnBDLR registers, which aren't contiguous. */
+static const uint32_t dx0bdlr[DDR_TC_DX_BDLR_NUM] = {
+	PUB_DX0BDLR0, PUB_DX0BDLR1, PUB_DX0BDLR2, PUB_DX0BDLR3, PUB_DX0BDLR4,
+	PUB_DX0BDLR5, PUB_DX0BDLR6, PUB_DX0BDLR7, PUB_DX0BDLR8, PUB_DX0BDLR9,
+};
+
+/*
+ * The cache is only used by the first setup of each MSS in a boot, any
+ * later setup (e.g. from the console) really trains the memory and doesn't
+ * overwrite the cached results.
+ */
+#define TC_UNUSED		0
+#define TC_LOOKED_UP		1
+#define TC_DONE			2
+
+static uint8_t tc_state[MAX_MEM_CTRL];
+
+#define DX_STRIDE		(PUB_DX1LCDLR0 - PUB_DX0LCDLR0)
+#define DX_REG(reg0, byte)	((reg0) + (byte) * DX_STRIDE)
+
+/* Each MSS owns one entry of the cache. */
+static struct ddr_train_cache_entry *cur_entry(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+
+	return (struct ddr_train_cache_entry *)DDR_TRAIN_CACHE_BASE +
+		dp->mss_index;
+}
+
+static uint32_t crc_data(uint32_t crc, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+
+	for (; len >= sizeof(uint32_t); len -= sizeof(uint32_t)) {
+		uint32_t word;
+
+		memcpy(&word, p, sizeof(word));
+		__asm__("crc32w %w0, %w0, %w1" : "+r" (crc) : "r" (word));
+		p += sizeof(word);
+	}
+	for (; len > 0; len--)
+		__asm__("crc32b %w0, %w0, %w1" : "+r" (crc) : "r" (*p++));
+
+	return crc;
+}
+
+static uint32_t entry_crc(const struct ddr_train_cache_entry *e)
+{
+	return ~crc_data(~0, &e->key, sizeof(*e) -
+			 offsetof(struct ddr_train_cache_entry, key));
+}
+
+/*
+ * The training results are only valid for the same DIMMs (identified by
+ * their SPD contents, which include the SPD CRCs, and serial numbers) in
+ * the same slots, trained at the same speed.
+ */
+static uint32_t entry_key(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	uint32_t key = ~0;
+
+	for (int i = 0; i < MAX_DIMM_PER_MEM_CTRL; i++) {
+		key = crc_data(key, dp->dimm[i].spd, sizeof(dp->dimm[i].spd));
+		key = crc_data(key, dp->dimm[i].serial,
+			       sizeof(dp->dimm[i].serial));
+	}
+	key = crc_data(key, &dp->tck, sizeof(dp->tck));
+	key = crc_data(key, &dp->type, sizeof(dp->type));
+	key = crc_data(key, &dp->mss_index, sizeof(dp->mss_index));
+
+	return ~key;
+}
+
+/*
+ * Check if we have valid training results for the current MSS.
+ * Return 1 if so, else 0.
+ */
+int ddr_train_cache_lookup(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	struct ddr_train_cache_entry *e = cur_entry();
+
+	if (tc_state[dp->mss_index] != TC_UNUSED)
+		return 0;
+	tc_state[dp->mss_index] = TC_LOOKED_UP;
+
+	/*
+	 * The LRDIMM data buffers lose their trained state along with the
+	 * DIMM, so they can't be restored from the PHY state alone.
+	 */
+	if (dp->type == LRDIMM)
+		return 0;
+
+	inv_dcache_range((uintptr_t)e, sizeof(*e));
+
+	if (e->magic != DDR_TRAIN_CACHE_MAGIC ||
+	    e->crc != entry_crc(e) ||
+	    e->key != entry_key() ||
+	    e->active_ranks != dp->active_ranks)
+		return 0;
+
+	MEM_VERB("Found cached training results for MSS%d.\n",
+		 dp->mss_index);
+
+	return 1;
+}
+
+/*
+ * Restore the SDRAM VREF results into the mode register values, so that
+ * they are programmed into the SDRAM during its initialization.
+ */
+void ddr_train_cache_restore_mr(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	struct ddr_train_cache_entry *e = cur_entry();
+
+	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
+		if ((dp->active_ranks & (1 << rank)) == 0)
+			continue;
+
+		MR(6, rank) = e->mr6[rank];
+		for (int byte = 0; byte < BYTELANE_NUM; byte++) {
+			dp->res_mr6_vref[rank][byte] = e->mr6_vref[rank][byte];
+			dp->res_mr6_vref_x4[rank][byte] =
+				e->mr6_vref_x4[rank][byte];
+		}
+	}
+}
+
+/*
+ * Write a PUB register and read it back.
+ * Return 1 if it holds the value written, else 0.
+ */
+static int restore_pub_reg(uint32_t reg, uint32_t val)
+{
+	pub_write(reg, val);
+
+	return pub_read(reg) == val;
+}
+
+/*
+ * Write back the trained DDR PHY delays and VREF settings, along with the
+ * read latency of the memory controller. Every register is read back
+ * before the PHY leaves the PUB mode and can adjust the delays itself.
+ * Return 1 if they all hold the cached values, else 0.
+ */
+int ddr_train_cache_restore_phy(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	struct ddr_train_cache_entry *e = cur_entry();
+	int ok = 1;
+
+	SET_MEM_REG_FIELD(pub, PUB_PGCR1, pubmode, 0x1);
+
+	for (int byte = 0; byte < BYTELANE_NUM; byte++) {
+		for (int i = 0; i < DDR_TC_DX_BDLR_NUM; i++)
+			ok &= restore_pub_reg(DX_REG(dx0bdlr[i], byte),
+					      e->bdlr[byte][i]);
+		for (int i = 0; i < DDR_TC_DX_GCR_NUM; i++)
+			ok &= restore_pub_reg(DX_REG(PUB_DX0GCR5 + i, byte),
+					      e->gcr[byte][i]);
+	}
+	ok &= restore_pub_reg(PUB_VTDR, e->vtdr);
+
+	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
+		if ((dp->active_ranks & (1 << rank)) == 0)
+			continue;
+
+		pub_switch_rankidr(rank, 1, 1);
+		for (int byte = 0; byte < BYTELANE_NUM; byte++) {
+			for (int i = 0; i < DDR_TC_DX_LCDLR_NUM; i++)
+				ok &= restore_pub_reg(
+					DX_REG(PUB_DX0LCDLR0 + i, byte),
+					e->lcdlr[rank][byte][i]);
+			ok &= restore_pub_reg(DX_REG(PUB_DX0GTR0, byte),
+					      e->gtr0[rank][byte]);
+		}
+	}
+	pub_switch_rankidr(0, 1, 1);
+
+	SET_MEM_REG_FIELD(pub, PUB_PGCR1, pubmode, 0);
+	mem_config_ndelay(10 * NS_PER_US);
+
+	emc_write(EMC_EXT_MC_LATENCY, e->ext_mc_latency);
+
+	if (!ok)
+		MEM_LOG("Restored DDR PHY state of MSS%d doesn't match the "
+			"cached one.\n", dp->mss_index);
+
+	return ok;
+}
+
+/* Save the results of a successful training of the current MSS. */
+void ddr_train_cache_save(void)
+{
+	struct ddr_params *dp = ddr_cur_dp();
+	struct ddr_train_cache_entry *e = cur_entry();
+
+	if (tc_state[dp->mss_index] != TC_LOOKED_UP || dp->type == LRDIMM)
+		return;
+	tc_state[dp->mss_index] = TC_DONE;
+
+	memset(e, 0, sizeof(*e));
+	e->key = entry_key();
+	e->active_ranks = dp->active_ranks;
+
+	for (int byte = 0; byte < BYTELANE_NUM; byte++) {
+		for (int i = 0; i < DDR_TC_DX_BDLR_NUM; i++)
+			e->bdlr[byte][i] = pub_read(DX_REG(dx0bdlr[i], byte));
+		for (int i = 0; i < DDR_TC_DX_GCR_NUM; i++)
+			e->gcr[byte][i] = pub_read(DX_REG(PUB_DX0GCR5 + i,
+							  byte));
+	}
+	e->vtdr = pub_read(PUB_VTDR);
+	e->ext_mc_latency = emc_read(EMC_EXT_MC_LATENCY);
+
+	for (int rank = 0; rank < MAX_ACTIVE_RANKS; rank++) {
+		if ((dp->active_ranks & (1 << rank)) == 0)
+			continue;
+
+		pub_switch_rankidr(rank, 1, 1);
+		for (int byte = 0; byte < BYTELANE_NUM; byte++) {
+			for (int i = 0; i < DDR_TC_DX_LCDLR_NUM; i++)
+				e->lcdlr[rank][byte][i] =
+				  pub_read(DX_REG(PUB_DX0LCDLR0 + i, byte));
+			e->gtr0[rank][byte] = pub_read(DX_REG(PUB_DX0GTR0,
+							      byte));
+			e->mr6_vref[rank][byte] = dp->res_mr6_vref[rank][byte];
+			e->mr6_vref_x4[rank][byte] =
+				dp->res_mr6_vref_x4[rank][byte];
+		}
+		e->mr6[rank] = MR(6, rank);
+	}
+	pub_switch_rankidr(0, 1, 1);
+
+	e->crc = entry_crc(e);
+	e->magic = DDR_TRAIN_CACHE_MAGIC;
+
+	flush_dcache_range((uintptr_t)e, sizeof(*e));
+}
+
+/* Forget about the training results of the current MSS. */
+void ddr_train_cache_invalidate(void)
+{
+	struct ddr_train_cache_entry *e = cur_entry();
+
+	e->magic = 0;
+	flush_dcache_range((uintptr_t)e, sizeof(*e));
+}
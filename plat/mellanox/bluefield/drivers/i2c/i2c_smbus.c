@@ -1,4 +1,7 @@
+#include <arch_helpers.h>
 #include <i2c_smbus.h>
+#include <platform.h>
+#include <spinlock.h>
 
 /* Polling frequency in microseconds */
 #define POLL_FREQ_IN_USEC       1
@@ -84,17 +87,13 @@ static uint16_t i2c_smbus_master_poll_cause(uint32_t timeout)
 }
 
 /*
- * Poll SMBus master status and return transaction status, i.e. whether
- * succeeded or failed.
+ * Parse the cause bits of a finished transaction along with the SMBus master
+ * status and return transaction status, i.e. whether succeeded or failed.
  */
-static int i2c_smbus_poll_status(void)
+static int i2c_smbus_parse_status(uint32_t cause_status_bits)
 {
-	uint32_t cause_status_bits;
 	uint32_t master_status_bits;
 
-	/* First, poll cause status bits */
-	cause_status_bits = i2c_smbus_master_poll_cause(SMBUS_TRANSFER_TIMEOUT);
-
 	/*
 	 * Parse both Cause and Master GW bits, and return transaction status.
 	 */
@@ -139,6 +138,17 @@ static int i2c_smbus_poll_status(void)
 	return SMBUS_TRANSFER_FAILURE;
 }
 
+/*
+ * Poll SMBus master status and return transaction status, i.e. whether
+ * succeeded or failed.
+ */
+static int i2c_smbus_poll_status(void)
+{
+	/* First, poll cause status bits */
+	return i2c_smbus_parse_status(
+			i2c_smbus_master_poll_cause(SMBUS_TRANSFER_TIMEOUT));
+}
+
 static uint8_t i2c_smbus_set_control(uint8_t   slave,
 				     uint32_t  command,
 				     uint32_t  transmitted,
@@ -233,15 +243,17 @@ static void i2c_smbus_read_data(uint8_t *buffer,
 	}
 }
 
-static int i2c_smbus_read(uint8_t  slave,
-			  uint8_t *data,
-			  uint8_t  length,
-			  uint8_t  pec_en)
+/*
+ * Activate the Master GW to read 'desc_len' bytes, at most
+ * MASTER_DATA_R_LENGTH, from the slave. The caller must make sure that the
+ * GW is idle.
+ */
+static void i2c_smbus_gw_read(uint8_t slave,
+			      uint8_t desc_len,
+			      uint8_t pec_en)
 {
 	uint32_t data32, control32;
 	uint8_t  read_size;
-	uint8_t  desc_len;
-	int      status;
 
 	/*
 	 * The Smbus Data Read flow:
@@ -252,63 +264,83 @@ static int i2c_smbus_read(uint8_t  slave,
 	 * at the beginning.
 	 */
 
+	/* Set slave address byte */
+	data32 = (slave & 0x7f) << 1;
+
+	/* Write control bytes into Master GW Data Descriptor */
+	TYU_WRITE_DATA(MASTER_DATA_DESC_ADDR, data32);
+
+	/* The HW requires that SW subtract 1 */
+	read_size = desc_len - 1;
+
+	/* Set Master GW control words */
+	control32  = 0;
+	control32 |= 0x1       << MASTER_LOCK_BIT_OFF;
+	control32 |= 0x1       << MASTER_BUSY_BIT_OFF;
+	control32 |= slave     << MASTER_SLV_ADDR_BIT_OFF;
+	control32 |= 0x1       << MASTER_START_BIT_OFF;
+	control32 |= 0x1       << MASTER_STOP_BIT_OFF;
+	control32 |= read_size << MASTER_READ_BIT_OFF;
+	control32 |= 0x1       << MASTER_CTL_READ_BIT_OFF;
+	control32 |= 0         << MASTER_WRITE_BIT_OFF;
+	control32 |= 0         << MASTER_CTL_WRITE_BIT_OFF;
+	control32 |= 0         << MASTER_PARSE_EXP_BIT_OFF;
+	control32 |= pec_en    << MASTER_SEND_PEC_BIT_OFF;
+
+	TYU_WRITE(SMBUS_MASTER_STATUS, 0x0);	/* Clear status bits  */
+	TYU_WRITE(TYU_CAUSE_OR_BULK,  ~0x0);	/* Set the cause data */
+	TYU_WRITE(SMBUS_MASTER_PEC,    0x0);	/* Zero PEC byte      */
+	TYU_WRITE(SMBUS_RS_BYTES,      0x0);	/* Zero byte count    */
+
+	TYU_WRITE(SMBUS_MASTER_GW, control32);	/* GW activation      */
+}
+
+/* Collect the data of a successful i2c_smbus_gw_read(). */
+static void i2c_smbus_gw_read_done(uint8_t *data,
+				   uint8_t  desc_len)
+{
+	/* Read data bytes */
+	i2c_smbus_read_data(data, desc_len);
+
+	/*
+	 * After a read operation the SMBus FSM ps (present state)
+	 * needs to be 'manually' reset. This should be removed in
+	 * next tag integration.
+	 */
+	TYU_WRITE(SMBUS_MASTER_FSM, SMBUS_MASTER_FSM_PS_STATE_MASK);
+}
+
+static int i2c_smbus_read(uint8_t  slave,
+			  uint8_t *data,
+			  uint8_t  length,
+			  uint8_t  pec_en)
+{
+	uint8_t  desc_len;
+	int      status;
+
 	/* Check whether the SMBus Master GW is idle */
 	if (!i2c_smbus_master_is_idle())
 		return SMBUS_DEVICE_BUSY;
 
-	/* Set slave address byte */
-	data32 = (slave & 0x7f) << 1;
-
 	while (length > 0) {
-		/* Write control bytes into Master GW Data Descriptor */
-		TYU_WRITE_DATA(MASTER_DATA_DESC_ADDR, data32);
-
 		/* Set number of data bytes to read. Unlike the write, the
 		 * read operation allows the master controller to read up to
 		 * 128 bytes.
 		 */
 		desc_len = (length <= MASTER_DATA_R_LENGTH) ?
 		    length : MASTER_DATA_R_LENGTH;
-		/* The HW requires that SW subtract 1 */
-		read_size = desc_len - 1;
-
-		/* Set Master GW control words */
-		control32  = 0;
-		control32 |= 0x1       << MASTER_LOCK_BIT_OFF;
-		control32 |= 0x1       << MASTER_BUSY_BIT_OFF;
-		control32 |= slave     << MASTER_SLV_ADDR_BIT_OFF;
-		control32 |= 0x1       << MASTER_START_BIT_OFF;
-		control32 |= 0x1       << MASTER_STOP_BIT_OFF;
-		control32 |= read_size << MASTER_READ_BIT_OFF;
-		control32 |= 0x1       << MASTER_CTL_READ_BIT_OFF;
-		control32 |= 0         << MASTER_WRITE_BIT_OFF;
-		control32 |= 0         << MASTER_CTL_WRITE_BIT_OFF;
-		control32 |= 0         << MASTER_PARSE_EXP_BIT_OFF;
-		control32 |= pec_en    << MASTER_SEND_PEC_BIT_OFF;
-
-		TYU_WRITE(SMBUS_MASTER_STATUS, 0x0);	/* Clear status bits  */
-		TYU_WRITE(TYU_CAUSE_OR_BULK,  ~0x0);	/* Set the cause data */
-		TYU_WRITE(SMBUS_MASTER_PEC,    0x0);	/* Zero PEC byte      */
-		TYU_WRITE(SMBUS_RS_BYTES,      0x0);	/* Zero byte count    */
-
-		TYU_WRITE(SMBUS_MASTER_GW, control32);	/* GW activation      */
+
+		i2c_smbus_gw_read(slave, desc_len, pec_en);
 
 		/* Poll master status and check status bits */
 		status = i2c_smbus_poll_status();
 		if (status != 0)
 			return status;
 
-		/* Read data bytes */
-		i2c_smbus_read_data(data, desc_len);
-
-		/*
-		 * After a read operation the SMBus FSM ps (present state)
-		 * needs to be 'manually' reset. This should be removed in
-		 * next tag integration.
-		 */
-		TYU_WRITE(SMBUS_MASTER_FSM, SMBUS_MASTER_FSM_PS_STATE_MASK);
+		i2c_smbus_gw_read_done(data, desc_len);
 
 		/* Update remaining data bytes to read */
+		data   += desc_len;
 		length -= desc_len;
 	}
 
@@ -342,17 +374,21 @@ static void i2c_smbus_write_data(const uint8_t *buffer,
 	TYU_WRITE_DATA(MASTER_DATA_DESC_ADDR + offset, data32);
 }
 
-static int i2c_smbus_write(uint8_t        slave,
-			   uint32_t       command,
-			   const uint8_t *data,
-			   uint8_t        length,
-			   uint8_t        pec_en)
+/*
+ * Activate the Master GW to write the command bytes followed by as many of
+ * the 'length' data bytes as fit in the data descriptor. The caller must
+ * make sure that the GW is idle. Return the number of data bytes sent.
+ */
+static uint32_t i2c_smbus_gw_write(uint8_t        slave,
+				   uint32_t       command,
+				   const uint8_t *data,
+				   uint32_t       length,
+				   uint8_t        pec_en)
 {
 	uint32_t control32, control;
-	uint8_t  sent, write_size, byte, control_len, data_len;
+	uint8_t  write_size, byte, control_len, data_len;
 	uint8_t  data_desc[MASTER_DATA_DESC_SIZE] = { 0 };
 	uint8_t  desc_len, data_idx;
-	int      status;
 
 	/*
 	 * The Smbus Data Write flow:
@@ -363,6 +399,80 @@ static int i2c_smbus_write(uint8_t        slave,
 	 * Note that Master GW data is shifted left so the data will start at
 	 * the beginning.
 	 */
+
+	/*
+	 * Prepare the control bytes and its length, to send before
+	 * data bytes. Control bytes strongly depend on the SMBus
+	 * Command as well as the slave device, i.e. these bytes might
+	 * enable the control of the slave device.
+	 */
+	control_len = i2c_smbus_set_control(slave, command, 0, &control);
+
+	/*
+	 * Set number of data bytes to write. Unlike the read, the
+	 * write operation allows the master controller to write up to
+	 * 127 bytes only. The first data bytes might be reserved for
+	 * control bytes (e.g. command bytes). The total number of
+	 * bytes to write to the Master GW data descriptor includes the
+	 * slave address byte, control bytes and data bytes.
+	 */
+	data_len = (length <= (MASTER_DATA_W_LENGTH - control_len) ?
+		    length : (MASTER_DATA_W_LENGTH - control_len));
+	desc_len = control_len + data_len + 1;
+	/* The HW requires that SW subtract 1 */
+	write_size = desc_len - 1;
+
+	data_idx = 0;
+	/*
+	 * Write Slave address to the data descriptor buffer. Slave
+	 * address is shifted left by 1 as required by hardware.
+	 */
+	data_desc[data_idx++] = (slave & 0x7f) << 1;
+
+	/* Copy control data to the data descriptor */
+	for (byte = 0; byte < control_len; byte++, data_idx++)
+		data_desc[data_idx] =
+		    (control >> (24 - (8 * byte))) & 0xff;
+
+	/* Copy data to write to the data descriptor */
+	for (byte = 0; data_idx < desc_len; data_idx++, byte++)
+		data_desc[data_idx] = data[byte];
+
+	i2c_smbus_write_data(data_desc, desc_len);
+
+	/* Set Master GW control words */
+	control32  = 0;
+	control32 |= 0x1        << MASTER_LOCK_BIT_OFF;
+	control32 |= 0x1        << MASTER_BUSY_BIT_OFF;
+	control32 |= slave      << MASTER_SLV_ADDR_BIT_OFF;
+	control32 |= 0x1        << MASTER_START_BIT_OFF;
+	control32 |= 0x1        << MASTER_STOP_BIT_OFF;
+	control32 |= 0          << MASTER_READ_BIT_OFF;
+	control32 |= 0          << MASTER_CTL_READ_BIT_OFF;
+	control32 |= write_size << MASTER_WRITE_BIT_OFF;
+	control32 |= 0x1        << MASTER_CTL_WRITE_BIT_OFF;
+	control32 |= 0          << MASTER_PARSE_EXP_BIT_OFF;
+	control32 |= pec_en     << MASTER_SEND_PEC_BIT_OFF;
+
+	TYU_WRITE(SMBUS_MASTER_STATUS, 0x0);	/* Clear status bits  */
+	TYU_WRITE(TYU_CAUSE_OR_BULK,  ~0x0);	/* Set the cause data */
+	TYU_WRITE(SMBUS_MASTER_PEC,    0x0);	/* Zero PEC byte      */
+	TYU_WRITE(SMBUS_RS_BYTES,      0x0);	/* Zero byte count    */
+
+	TYU_WRITE(SMBUS_MASTER_GW, control32);	/* GW activation      */
+
+	return data_len;
+}
+
+static int i2c_smbus_write(uint8_t        slave,
+			   uint32_t       command,
+			   const uint8_t *data,
+			   uint8_t        length,
+			   uint8_t        pec_en)
+{
+	uint32_t sent, data_len;
+	int      status;
+
 	sent = 0;
 
 	/* Check whether the SMBus Master GW is idle */
@@ -370,67 +480,8 @@ static int i2c_smbus_write(uint8_t        slave,
 		return SMBUS_DEVICE_BUSY;
 
 	do {
-		/*
-		 * Prepare the control bytes and its length, to send before
-		 * data bytes. Control bytes strongly depend on the SMBus
-		 * Command as well as the slave device, i.e. these bytes might
-		 * enable the control of the slave device.
-		 */
-		control_len =
-		    i2c_smbus_set_control(slave, command, sent, &control);
-
-		/*
-		 * Set number of data bytes to write. Unlike the read, the
-		 * write operation allows the master controller to write up to
-		 * 127 bytes only. The first data bytes might be reserved for
-		 * control bytes (e.g. command bytes). The total number of
-		 * bytes to write to the Master GW data descriptor includes the
-		 * slave address byte, control bytes and data bytes.
-		 */
-		data_len = (length <= (MASTER_DATA_W_LENGTH - control_len) ?
-			    length : (MASTER_DATA_W_LENGTH - control_len));
-		desc_len = control_len + data_len + 1;
-		/* The HW requires that SW subtract 1 */
-		write_size = desc_len - 1;
-
-		data_idx = 0;
-		/*
-		 * Write Slave address to the data descriptor buffer. Slave
-		 * address is shifted left by 1 as required by hardware.
-		 */
-		data_desc[data_idx++] = (slave & 0x7f) << 1;
-
-		/* Copy control data to the data descriptor */
-		for (byte = 0; byte < control_len; byte++, data_idx++)
-			data_desc[data_idx] =
-			    (control >> (24 - (8 * byte))) & 0xff;
-
-		/* Copy data to write to the data descriptor */
-		for (; data_idx < desc_len; data_idx++, sent++)
-			data_desc[data_idx] = data[sent];
-
-		i2c_smbus_write_data(data_desc, desc_len);
-
-		/* Set Master GW control words */
-		control32  = 0;
-		control32 |= 0x1        << MASTER_LOCK_BIT_OFF;
-		control32 |= 0x1        << MASTER_BUSY_BIT_OFF;
-		control32 |= slave      << MASTER_SLV_ADDR_BIT_OFF;
-		control32 |= 0x1        << MASTER_START_BIT_OFF;
-		control32 |= 0x1        << MASTER_STOP_BIT_OFF;
-		control32 |= 0          << MASTER_READ_BIT_OFF;
-		control32 |= 0          << MASTER_CTL_READ_BIT_OFF;
-		control32 |= write_size << MASTER_WRITE_BIT_OFF;
-		control32 |= 0x1        << MASTER_CTL_WRITE_BIT_OFF;
-		control32 |= 0          << MASTER_PARSE_EXP_BIT_OFF;
-		control32 |= pec_en     << MASTER_SEND_PEC_BIT_OFF;
-
-		TYU_WRITE(SMBUS_MASTER_STATUS, 0x0);	/* Clear status bits  */
-		TYU_WRITE(TYU_CAUSE_OR_BULK,  ~0x0);	/* Set the cause data */
-		TYU_WRITE(SMBUS_MASTER_PEC,    0x0);	/* Zero PEC byte      */
-		TYU_WRITE(SMBUS_RS_BYTES,      0x0);	/* Zero byte count    */
-
-		TYU_WRITE(SMBUS_MASTER_GW, control32);	/* GW activation      */
+		data_len = i2c_smbus_gw_write(slave, command + sent,
+					      data + sent, length, pec_en);
 
 		/*
 		 * Poll master status and check status bits.
@@ -446,6 +497,7 @@ static int i2c_smbus_write(uint8_t        slave,
 		 * bytes does not count. Indeed, these bytes are required by
 		 * the write transfer.
 		 */
+		sent   += data_len;
 		length -= data_len;
 	} while (length > 0);
 
@@ -513,24 +565,222 @@ int i2c_smbus_start_transaction(uint8_t        slave,
 	return status;
 }
 
+/*******************************************************************************
+ * Queued transaction engine
+ *
+ * Transfers are queued and run one after the other, each as a back to back
+ * sequence of Master GW activations: a read message writes its command then
+ * reads up to MASTER_DATA_R_LENGTH bytes per activation, a write message
+ * sends its command followed by up to MASTER_DATA_W_LENGTH bytes (minus the
+ * command bytes) per activation. The engine never waits on the hardware;
+ * i2c_smbus_poll() checks the cause bits of the current activation and
+ * starts the next one, so it may be called from a polling loop or from an
+ * interrupt handler.
+ ******************************************************************************/
+
+/* Phase of the current message. */
+#define I2C_SMBUS_PHASE_CMD	0	/* Nothing sent yet */
+#define I2C_SMBUS_PHASE_DATA	1	/* Command sent, moving data */
+
+static spinlock_t i2c_smbus_lock;
+static i2c_smbus_xfer_t *i2c_smbus_head, *i2c_smbus_tail;
+/* Set while a Master GW activation for the head transfer is in flight. */
+static int i2c_smbus_gw_active;
+
+/* Return a deadline 'usec' microseconds from now, in system counter ticks. */
+static uint64_t i2c_smbus_deadline(uint32_t usec)
+{
+	return read_cntpct_el0() +
+	       ((uint64_t)plat_get_syscnt_freq2() * usec) / 1000000;
+}
+
+/* Remove the head transfer from the queue and report its status. */
+static void i2c_smbus_xfer_complete(int status)
+{
+	i2c_smbus_xfer_t *xfer = i2c_smbus_head;
+
+	i2c_smbus_head = xfer->next;
+	if (i2c_smbus_head == NULL)
+		i2c_smbus_tail = NULL;
+	i2c_smbus_gw_active = 0;
+
+	xfer->status = status;
+	if (xfer->done != NULL)
+		xfer->done(xfer);
+}
+
+/*
+ * Start the next Master GW activation of the head transfer, completing
+ * messages and the transfer itself as they run out of bytes. Returns 0 if
+ * an activation was started or the transfer completed, or
+ * SMBUS_DEVICE_BUSY if the GW is not idle yet.
+ */
+static int i2c_smbus_xfer_step(i2c_smbus_xfer_t *xfer)
+{
+	i2c_smbus_msg_t *msg;
+	uint8_t pec_en;
+
+	/* Skip the messages we are done with. */
+	while (xfer->msg_idx < xfer->msg_cnt) {
+		msg = &xfer->msgs[xfer->msg_idx];
+		if (xfer->phase == I2C_SMBUS_PHASE_CMD ||
+		    xfer->offset < msg->length)
+			break;
+		xfer->msg_idx++;
+		xfer->offset = 0;
+		xfer->phase  = I2C_SMBUS_PHASE_CMD;
+	}
+
+	if (xfer->msg_idx == xfer->msg_cnt) {
+		i2c_smbus_xfer_complete(SMBUS_NO_ERROR);
+		return 0;
+	}
+
+	/* Same check as i2c_smbus_master_is_idle(), without waiting. */
+	if (TYU_READ(SMBUS_MASTER_FSM) & SMBUS_MASTER_FSM_STOP_MASK)
+		return SMBUS_DEVICE_BUSY;
+
+	msg    = &xfer->msgs[xfer->msg_idx];
+	pec_en = (msg->flags & I2C_FLAG_SMBUS_PEC) ? 1 : 0;
+
+	if (xfer->phase == I2C_SMBUS_PHASE_DATA) {
+		/* Continue reading where the previous activation stopped. */
+		xfer->chunk = msg->length - xfer->offset;
+		if (xfer->chunk > MASTER_DATA_R_LENGTH)
+			xfer->chunk = MASTER_DATA_R_LENGTH;
+		i2c_smbus_gw_read(msg->slave, xfer->chunk, pec_en);
+	} else if (msg->flags & I2C_FLAG_READ) {
+		/* Send the internal device address to read from. */
+		xfer->chunk = i2c_smbus_gw_write(msg->slave, msg->command,
+						 NULL, 0, pec_en);
+	} else {
+		xfer->chunk = i2c_smbus_gw_write(msg->slave,
+						 msg->command + xfer->offset,
+						 msg->buffer + xfer->offset,
+						 msg->length - xfer->offset,
+						 pec_en);
+	}
+
+	xfer->deadline      = i2c_smbus_deadline(SMBUS_TRANSFER_TIMEOUT);
+	i2c_smbus_gw_active = 1;
+
+	return 0;
+}
+
+/* Advance the queue as far as possible without waiting. */
+static void __i2c_smbus_poll(void)
+{
+	i2c_smbus_xfer_t *xfer;
+	i2c_smbus_msg_t *msg;
+	uint32_t cause;
+	int status;
+
+	while ((xfer = i2c_smbus_head) != NULL) {
+		if (!i2c_smbus_gw_active) {
+			status = i2c_smbus_xfer_step(xfer);
+			if (status == 0)
+				continue;
+			if (read_cntpct_el0() > xfer->deadline)
+				i2c_smbus_xfer_complete(status);
+			return;
+		}
+
+		cause  = TYU_READ(TYU_CAUSE_ARBITER_BITS);
+		cause &= TYU_CAUSE_ARBITER_BITS_MASK;
+		if (cause == 0) {
+			if (read_cntpct_el0() <= xfer->deadline)
+				return;
+			/* Let the status bits tell what went wrong. */
+		}
+
+		i2c_smbus_gw_active = 0;
+
+		status = i2c_smbus_parse_status(cause);
+		if (status != 0) {
+			i2c_smbus_xfer_complete(status);
+			continue;
+		}
+
+		msg = &xfer->msgs[xfer->msg_idx];
+		if (xfer->phase == I2C_SMBUS_PHASE_DATA &&
+		    (msg->flags & I2C_FLAG_READ))
+			i2c_smbus_gw_read_done(msg->buffer + xfer->offset,
+					       xfer->chunk);
+		if (xfer->phase == I2C_SMBUS_PHASE_DATA ||
+		    !(msg->flags & I2C_FLAG_READ))
+			xfer->offset += xfer->chunk;
+		xfer->phase = I2C_SMBUS_PHASE_DATA;
+
+		/* Give the next activation a fresh timeout for the GW. */
+		xfer->deadline = i2c_smbus_deadline(SMBUS_START_TRANS_TIMEOUT);
+	}
+}
+
+int i2c_smbus_submit(i2c_smbus_xfer_t *xfer)
+{
+	assert(xfer != NULL);
+
+	for (uint32_t i = 0; i < xfer->msg_cnt; i++)
+		if (xfer->msgs[i].length != 0 && xfer->msgs[i].buffer == NULL)
+			return SMBUS_TRANSFER_FAILURE;
+
+	xfer->status   = SMBUS_XFER_PENDING;
+	xfer->msg_idx  = 0;
+	xfer->offset   = 0;
+	xfer->phase    = I2C_SMBUS_PHASE_CMD;
+	xfer->deadline = i2c_smbus_deadline(SMBUS_START_TRANS_TIMEOUT);
+	xfer->next     = NULL;
+
+	spin_lock(&i2c_smbus_lock);
+	if (i2c_smbus_tail != NULL)
+		i2c_smbus_tail->next = xfer;
+	else
+		i2c_smbus_head = xfer;
+	i2c_smbus_tail = xfer;
+	__i2c_smbus_poll();
+	spin_unlock(&i2c_smbus_lock);
+
+	return 0;
+}
+
+void i2c_smbus_poll(void)
+{
+	spin_lock(&i2c_smbus_lock);
+	__i2c_smbus_poll();
+	spin_unlock(&i2c_smbus_lock);
+}
+
+int i2c_smbus_wait(i2c_smbus_xfer_t *xfer)
+{
+	while (xfer->status == SMBUS_XFER_PENDING) {
+		udelay(POLL_FREQ_IN_USEC);
+		i2c_smbus_poll();
+	}
+
+	return xfer->status;
+}
+
+int i2c_smbus_transfer_msgs(i2c_smbus_msg_t *msgs, uint32_t msg_cnt)
+{
+	i2c_smbus_xfer_t xfer = {
+		.msgs    = msgs,
+		.msg_cnt = msg_cnt,
+	};
+	int status;
+
+	status = i2c_smbus_submit(&xfer);
+	if (status != 0)
+		return status;
+
+	return i2c_smbus_wait(&xfer);
+}
+
 int i2c_smbus_transfer(uint8_t   device,
 		       uint16_t  address,
 		       uint32_t  length,
 		       uint8_t  *buffer,
 		       uint8_t   operation)
 {
-	i2c_request_t request;
-	uint32_t      buf_len, transmitted;
-	uint16_t      curr_addr;
-	uint8_t       op_idx;
-	int           status;
-
-	op_idx      = 0;
-	transmitted = 0;
-	curr_addr   = address;
-	status      = SMBUS_NO_ERROR;
-
-	request.operation_cnt = 1;
 	/*
 	 * The master might use a combined W-R cycle to the slave. It can also
 	 * do an W-W. The "Write followed by Read" operation sequence is by far
@@ -538,46 +788,26 @@ int i2c_smbus_transfer(uint8_t   device,
 	 * a command to a device and then read data based on the command sent.
 	 * For instance, the W-R operations could be used to read from EEPROMs.
 	 * The initial write tells the EEPROM of the specific offset to be read
-	 * from in the subsequent read operation. Note that operation count is
-	 * set to 1 when EEPROM_WRITE is set because the underlying Mellanox
-	 * SMBus hardware is able to perform the W-W operation through a single
-	 * command. Unlike the W-W the combined R-W requires two separate
-	 * operations.
+	 * from in the subsequent read operations, which the engine issues in
+	 * blocks as large as the Master GW data descriptor allows. Note that
+	 * the underlying Mellanox SMBus hardware is able to perform the W-W
+	 * operation through a single command.
 	 */
-	if (operation == I2C_SMBUS_READ) {
-		request.operation[op_idx].byte_len = 0;
-		request.operation_cnt++;
-		op_idx++;
-	}
-
-	request.operation[op_idx].flags =
-	    (operation == I2C_SMBUS_READ) ? I2C_FLAG_READ : 0;
-
-	while (length > 0) {
-		/* Set transaction control bytes (internal device address) */
-		curr_addr = address + transmitted;
-		buf_len   = (length <= MAX_BUFFER_LENGTH) ?
-			length : MAX_BUFFER_LENGTH;
-		request.operation[op_idx].byte_len = buf_len;
-		request.operation[op_idx].buffer   = buffer + transmitted;
-
-		/* Start I2C transaction */
-		status =
-		    i2c_smbus_start_transaction(device, curr_addr, &request);
-		if (status != 0)
-			break;
-
-		length      -= buf_len;
-		transmitted += buf_len;
-	}
-
-	return status;
+	i2c_smbus_msg_t msg = {
+		.flags   = (operation == I2C_SMBUS_READ) ? I2C_FLAG_READ : 0,
+		.slave   = device,
+		.command = address,
+		.length  = length,
+		.buffer  = buffer,
+	};
+
+	return i2c_smbus_transfer_msgs(&msg, 1);
 }
 
-int i2c_smbus_spd_read(uint8_t   device,
-		       uint16_t  address,
-		       uint16_t  length,
-		       uint8_t  *buffer)
+static int __i2c_smbus_spd_read(uint8_t   device,
+				uint16_t  address,
+				uint16_t  length,
+				uint8_t  *buffer)
 {
 	uint16_t curr_addr, buf_len, read = 0;
 	uint8_t  prev_page, curr_page, dummy_byte = 0;
@@ -872,6 +1102,30 @@ static void i2c_smbus_init_timings(uint32_t config_khz)
 	i2c_smbus_set_timings(&timings);
 }
 
+/*
+ * Read the SPD EEPROM, switching the bus to I2C_SPD_TIMING_CONFIG_KHZ for the
+ * duration of the transfer.
+ */
+int i2c_smbus_spd_read(uint8_t   device,
+		       uint16_t  address,
+		       uint16_t  length,
+		       uint8_t  *buffer)
+{
+	int status;
+
+#if I2C_SPD_TIMING_CONFIG_KHZ != I2C_TIMING_CONFIG_KHZ
+	i2c_smbus_init_timings(I2C_SPD_TIMING_CONFIG_KHZ);
+#endif
+
+	status = __i2c_smbus_spd_read(device, address, length, buffer);
+
+#if I2C_SPD_TIMING_CONFIG_KHZ != I2C_TIMING_CONFIG_KHZ
+	i2c_smbus_init_timings(I2C_TIMING_CONFIG_KHZ);
+#endif
+
+	return status;
+}
+
 /*
  * Initialize the I2C SMBus. It consists of master initialization and Timer
  * settings.
@@ -197,6 +197,15 @@ typedef struct {
 
 #define I2C_TIMING_CONFIG_KHZ  100
 
+/*
+ * Bus frequency used while reading the SPD EEPROMs. DDR4 SPD devices (EE1004)
+ * run up to 1MHz, but other devices sharing the bus may not, so boards have
+ * to opt in through the I2C_SPD_TIMING_CONFIG_KHZ build option.
+ */
+#ifndef I2C_SPD_TIMING_CONFIG_KHZ
+#define I2C_SPD_TIMING_CONFIG_KHZ  I2C_TIMING_CONFIG_KHZ
+#endif
+
 /*
  * The I2C device operation describes a subset of an I2C transaction in which
  * the I2C controller is either sending or receiving bytes from the bus. Some
@@ -282,6 +291,74 @@ int i2c_smbus_transfer(uint8_t   device,
 		       uint8_t  *buffer,
 		       uint8_t   operation);
 
+/*
+ * A message of a queued transfer: either write 'length' bytes to, or read
+ * 'length' bytes from, internal address 'command' of the slave device. A
+ * read message first writes the command, then reads the data in blocks of
+ * up to MASTER_DATA_R_LENGTH bytes.
+ */
+typedef struct {
+	uint32_t  flags;	/* I2C_FLAG_READ and/or I2C_FLAG_SMBUS_PEC */
+	uint8_t   slave;	/* 7-bit address of the slave on the bus */
+	uint16_t  command;	/* Internal device address */
+	uint32_t  length;	/* Data length, 0 to only send the command */
+	uint8_t  *buffer;	/* Source/destination data buffer */
+} i2c_smbus_msg_t;
+
+typedef struct i2c_smbus_xfer i2c_smbus_xfer_t;
+
+/*
+ * Completion callback of a queued transfer. It is called with the engine
+ * lock held, from whichever context advanced the engine, so it must not
+ * call back into the engine.
+ */
+typedef void (*i2c_smbus_done_t)(i2c_smbus_xfer_t *xfer);
+
+/* Status of a queued transfer that has not completed yet. */
+#define SMBUS_XFER_PENDING	(-1)
+
+/*
+ * A queued transfer: its messages run back to back, without messages of
+ * other transfers in between. Only 'msgs', 'msg_cnt', 'done' and 'arg' are
+ * set by the caller; the structure belongs to the engine until 'status'
+ * is no longer SMBUS_XFER_PENDING.
+ */
+struct i2c_smbus_xfer {
+	i2c_smbus_msg_t  *msgs;
+	uint32_t          msg_cnt;
+	i2c_smbus_done_t  done;		/* Optional completion callback */
+	void             *arg;		/* For the use of the callback */
+	volatile int      status;	/* 0 on success, >0 on failure */
+
+	/* Private to the engine */
+	uint32_t          msg_idx;
+	uint32_t          offset;
+	uint32_t          chunk;
+	uint8_t           phase;
+	uint64_t          deadline;
+	i2c_smbus_xfer_t *next;
+};
+
+/*
+ * Queue a transfer and start it if the bus is free. Return 0 if queued, or
+ * >0 if the transfer is malformed.
+ */
+int i2c_smbus_submit(i2c_smbus_xfer_t *xfer);
+
+/*
+ * Advance the queued transfers without waiting on the hardware: collect the
+ * result of the current Master GW activation if it is done and start the
+ * next one. Completion is only noticed through this, so whoever waits on a
+ * transfer must call it, from a polling loop or an interrupt handler.
+ */
+void i2c_smbus_poll(void);
+
+/* Poll until the given transfer completes; return its status. */
+int i2c_smbus_wait(i2c_smbus_xfer_t *xfer);
+
+/* Run the given messages as one transfer and wait for it to complete. */
+int i2c_smbus_transfer_msgs(i2c_smbus_msg_t *msgs, uint32_t msg_cnt);
+
 /*
  * This function consists of an interface to read 512-byte, JEDEC
  * JC-42.4-compliant EEPROM that is segregated into two 256-byte,
@@ -30,9 +30,16 @@
 
 #include <assert.h>
 #include <debug.h>
+#include <errno.h>
 #include <io_driver.h>
 #include <io_storage.h>
 #include <mmio.h>
+#include <platform_def.h>
+#include <string.h>
+#include <utils_def.h>
+#if defined(BF_BOOT_COMPRESS) && !defined(IMAGE_BL1)
+#include <zlib.h>
+#endif
 
 #include <bluefield_def.h>
 
@@ -71,14 +78,57 @@ static uint64_t residue;
 /* How many bytes have we read or skipped from the current image? */
 static int cur_offset;
 
+/*
+ * Length of the current image as returned to the reader; for a compressed
+ * image this is the decompressed length, and cur_offset (like image_len)
+ * counts the compressed bytes of the stream instead.
+ */
+static int image_size;
+
+/* How many decompressed bytes have been returned from the current image? */
+static int out_offset;
+
+
+/*
+ * Wait until the boot FIFO has data, and return the number of words which
+ * can be read from it without checking again, up to a maximum of max.
+ */
+static uint64_t boot_fifo_wait(uint64_t max)
+{
+	uint64_t c;
+
+	while ((c = mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_COUNT)) == 0)
+		;
+
+	return c < max ? c : max;
+}
+
+/* Read one word from the boot FIFO and fold it into the partial CRC. */
+static inline uint64_t boot_fifo_read_crc(uint32_t *crc)
+{
+	uint64_t d = mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_DATA);
+
+	/* FIXME use a compiler instrinsic here, once we have one */
+	__asm__("crc32x %w0, %w0, %x1" : "+r" (*crc) : "r" (d));
+
+	return d;
+}
 
 /*
  * Read bytes from the current image into a buffer, or throw them away if
  * the buffer is NULL.  We also keep track of the CRC of the data seen so
  * that we can check it at the end of the file.
+ *
+ * Whole words are drained from the FIFO in bursts of however many words
+ * it holds, so the count is only polled when a burst runs out.  Each word
+ * is folded into the CRC as it arrives; nothing waits on the CRC, so the
+ * core issues the next FIFO read while the crc32x of the previous word is
+ * still in flight and the CRC costs nothing on top of the FIFO latency.
  */
 static void read_bytes(uint8_t *buf, int bytes)
 {
+	uint32_t crc = partial_crc;
+
 	cur_offset += bytes;
 
 	while (bytes && residue_bytes) {
@@ -90,35 +140,29 @@ static void read_bytes(uint8_t *buf, int bytes)
 	}
 
 	uint64_t *buf64 = (uint64_t *)buf;
-	uint64_t c = mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_COUNT);
-
-	for (; bytes >= 8; bytes -= 8) {
-		if (c <= 0)
-			while ((c = mmio_read_64(RSHIM_BASE +
-						 RSH_BOOT_FIFO_COUNT)) <= 0)
-				;
-
-		uint64_t d = mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_DATA);
-
-		/* FIXME use a compiler instrinsic here, once we have one */
-		__asm__("crc32x %w0, %w0, %x1" : "+r" (partial_crc) : "r" (d));
-		if (buf64)
-			*buf64++ = d;
-		c--;
+	uint64_t words = bytes / 8;
+
+	while (words) {
+		uint64_t n = boot_fifo_wait(words);
+
+		words -= n;
+		if (buf64) {
+			for (; n; n--)
+				*buf64++ = boot_fifo_read_crc(&crc);
+		} else {
+			for (; n; n--)
+				boot_fifo_read_crc(&crc);
+		}
 	}
+	bytes %= 8;
 
 	if (bytes) {
 		buf = (uint8_t *)buf64;
 
-		if (c <= 0)
-			while ((c = mmio_read_64(RSHIM_BASE +
-						 RSH_BOOT_FIFO_COUNT)) <= 0)
-				;
+		boot_fifo_wait(1);
 
-		uint64_t d = mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_DATA);
+		uint64_t d = boot_fifo_read_crc(&crc);
 
-		/* FIXME use a compiler instrinsic here, once we have one */
-		__asm__("crc32x %w0, %w0, %x1" : "+r" (partial_crc) : "r" (d));
 		for (int i = 0; i < bytes; i++) {
 			if (buf)
 				*buf++ = d & 0xFF;
@@ -128,8 +172,181 @@ static void read_bytes(uint8_t *buf, int bytes)
 		residue = d;
 		residue_bytes = 8 - bytes;
 	}
+
+	partial_crc = crc;
+}
+
+#if defined(BF_BOOT_COMPRESS) && !defined(IMAGE_BL1)
+
+/*
+ * Compressed images are inflated as their data comes out of the boot FIFO:
+ * each time the input runs dry we take whatever words the FIFO holds (up
+ * to INFLATE_IN_WORDS) and run them through zlib straight into the
+ * caller's buffer, so the host keeps pushing the next part of the image
+ * over the rshim while we decompress the previous one.  The CRC is still
+ * that of the compressed data, computed by read_bytes() as usual.
+ *
+ * The compressed data bounces through the start of a scratch area in DRAM,
+ * and the rest of it is handed out to zlib for its state and window.
+ */
+#define INFLATE_IN_WORDS	512
+#define INFLATE_IN_BYTES	(INFLATE_IN_WORDS * 8)
+
+static z_stream stream;
+
+/* Has inflate been set up for the current image, and has it finished? */
+static uint8_t inflate_active;
+static uint8_t inflate_done;
+
+/* The part of the scratch area not yet handed out to zlib. */
+static uintptr_t zalloc_current;
+
+static voidpf inflate_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	uintptr_t p = round_up(zalloc_current, sizeof(void *));
+
+	size *= items;
+
+	if (p + size > BF_INFLATE_WORK_BASE + BF_INFLATE_WORK_SIZE)
+		return NULL;
+
+	memset((void *)p, 0, size);
+	zalloc_current = p + size;
+
+	return (voidpf)p;
+}
+
+static void inflate_zfree(voidpf opaque, voidpf ptr)
+{
+}
+
+/* Forget about any inflate state of the previous image. */
+static void inflate_reset(void)
+{
+	inflate_active = 0;
+	inflate_done = 0;
+	out_offset = 0;
+}
+
+/* Set up inflate for the current image, if it hasn't been already. */
+static int inflate_open(void)
+{
+	int zret;
+
+	if (inflate_active)
+		return 0;
+
+	if (header.data.compression != BFB_IMGHDR_COMP_GZIP) {
+		ERROR("BlueField boot: image %d unknown compression %d\n",
+		      header.data.image_id, header.data.compression);
+		return -ENOTSUP;
+	}
+
+	zalloc_current = BF_INFLATE_WORK_BASE + INFLATE_IN_BYTES;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.zalloc = inflate_zalloc;
+	stream.zfree = inflate_zfree;
+
+	zret = inflateInit(&stream);
+	if (zret != Z_OK) {
+		ERROR("BlueField boot: inflate init failed (ret = %d)\n", zret);
+		return -ENOMEM;
+	}
+
+	inflate_active = 1;
+
+	return 0;
+}
+
+/* Refill the inflate input with what the boot FIFO holds. */
+static int inflate_fill(void)
+{
+	uint8_t *in = (uint8_t *)BF_INFLATE_WORK_BASE;
+	int left = header.data.image_len - cur_offset;
+	int bytes;
+
+	if (left <= 0) {
+		ERROR("BlueField boot: image %d compressed data truncated\n",
+		      header.data.image_id);
+		return -EIO;
+	}
+
+	bytes = boot_fifo_wait(INFLATE_IN_WORDS) * 8;
+	if (bytes > left)
+		bytes = left;
+
+	read_bytes(in, bytes);
+
+	stream.next_in = in;
+	stream.avail_in = bytes;
+
+	return 0;
+}
+
+/*
+ * Decompress the next bytes of the current image into a buffer.  When the
+ * end of the image is reached we keep going until zlib has seen the end of
+ * the compressed stream, so that the gzip trailer gets checked as well,
+ * and then skip what's left of the image so the CRC can be checked.
+ */
+static int inflate_bytes(uint8_t *buf, int bytes)
+{
+	int last = out_offset + bytes >= image_size;
+	int zret;
+
+	stream.next_out = buf;
+	stream.avail_out = bytes;
+
+	while (!inflate_done && (stream.avail_out || last)) {
+		if (stream.avail_in == 0 && inflate_fill())
+			return -EIO;
+
+		zret = inflate(&stream, Z_NO_FLUSH);
+		if (zret == Z_STREAM_END) {
+			inflate_done = 1;
+		} else if (zret != Z_OK) {
+			ERROR("BlueField boot: image %d inflate failed (ret = %d)\n",
+			      header.data.image_id, zret);
+			return -EIO;
+		}
+	}
+
+	out_offset += bytes - stream.avail_out;
+
+	if (stream.avail_out) {
+		ERROR("BlueField boot: image %d only %d bytes decompressed\n",
+		      header.data.image_id, out_offset);
+		return -EIO;
+	}
+
+	if (inflate_done)
+		read_bytes(NULL, header.data.image_len - cur_offset);
+
+	return 0;
 }
 
+#else
+
+static void inflate_reset(void)
+{
+	out_offset = 0;
+}
+
+static int inflate_open(void)
+{
+	ERROR("BlueField boot: image %d is compressed\n",
+	      header.data.image_id);
+	return -ENOTSUP;
+}
+
+static int inflate_bytes(uint8_t *buf, int bytes)
+{
+	return -ENOTSUP;
+}
+
+#endif /* BF_BOOT_COMPRESS && !IMAGE_BL1 */
+
 /*
  * Read the next header from the data stream, skipping any unread bytes in
  * the current image first.
@@ -158,10 +375,28 @@ static void get_next_header(void)
 		panic();
 	}
 
-	/* Discard any extra header words. */
-	if (header.data.hdr_len > 3)
-		for (int i = 0; i < header.data.hdr_len - 3; i++)
-			(void) mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_DATA);
+	image_size = header.data.image_len;
+
+	/*
+	 * Discard any extra header words, except for the decompressed length
+	 * of compressed images.
+	 */
+	for (int i = 3; i < header.data.hdr_len; i++) {
+		uint64_t w;
+
+		boot_fifo_wait(1);
+		w = mmio_read_64(RSHIM_BASE + RSH_BOOT_FIFO_DATA);
+
+		if (i == 3 && header.data.compression != BFB_IMGHDR_COMP_NONE)
+			image_size = w & 0xFFFFFFFF;
+	}
+
+	if (header.data.compression != BFB_IMGHDR_COMP_NONE &&
+	    header.data.hdr_len < 4) {
+		ERROR("BlueField boot: compressed image %d without length\n",
+		      header.data.image_id);
+		panic();
+	}
 
 	INFO(
 	"BlueField ImgHdr V%d.%d Len %d ID %d ImLen %d HdCRC 0x%x FolIm 0x%lx\n",
@@ -171,10 +406,15 @@ static void get_next_header(void)
 	     header.data.image_crc,
 	     header.data.following_images);
 
+	if (header.data.compression != BFB_IMGHDR_COMP_NONE)
+		INFO("BlueField boot: compression %d, %d bytes decompressed\n",
+		     header.data.compression, image_size);
+
 	partial_crc = ~0;
 	residue_bytes = 0;
 	cur_offset = 0;
 	header_valid = 1;
+	inflate_reset();
 }
 
 
@@ -249,6 +489,13 @@ static int bf_file_open(io_dev_info_t *dev_info __attribute__((unused)),
 	while (header.data.image_id != id)
 		get_next_header();
 
+	if (header.data.compression != BFB_IMGHDR_COMP_NONE) {
+		int ret = inflate_open();
+
+		if (ret)
+			return ret;
+	}
+
 	entity->info = (uintptr_t) id;
 
 	return 0;
@@ -262,6 +509,10 @@ static int bf_file_seek(io_entity_t *entity, int mode, ssize_t offset)
 	assert((int) entity->info == header.data.image_id);
 	assert(header_valid);
 
+	/* Compressed images can only be read from start to end. */
+	if (header.data.compression != BFB_IMGHDR_COMP_NONE)
+		return -ENOTSUP;
+
 	/*
 	 * Adjust the input offset to the absolute byte position to seek
 	 * to.  We can only seek forward, so some modes are invalid.
@@ -299,7 +550,7 @@ static int bf_file_len(io_entity_t *entity, size_t *length)
 	assert(header_valid);
 	assert(length != NULL);
 
-	*length = (size_t) header.data.image_len;
+	*length = (size_t) image_size;
 
 	return 0;
 }
@@ -315,10 +566,21 @@ static int bf_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	assert(buffer != (uintptr_t)NULL);
 	assert(length_read != NULL);
 
-	if (cur_offset + length > header.data.image_len)
-		length = header.data.image_len - cur_offset;
+	if (header.data.compression != BFB_IMGHDR_COMP_NONE) {
+		int ret;
 
-	read_bytes((uint8_t *) buffer, length);
+		if (out_offset + length > image_size)
+			length = image_size - out_offset;
+
+		ret = inflate_bytes((uint8_t *) buffer, length);
+		if (ret)
+			return ret;
+	} else {
+		if (cur_offset + length > header.data.image_len)
+			length = header.data.image_len - cur_offset;
+
+		read_bytes((uint8_t *) buffer, length);
+	}
 
 	/*
 	 * If we've consumed the entire image, then the CRC should match
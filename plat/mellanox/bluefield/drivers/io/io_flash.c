@@ -152,7 +152,8 @@ void flash_print_data(uint32_t *data, uint32_t data_len)
 
 typedef struct {
 	volatile uint64_t is_empty;     /* If set, the segment has no data */
-	uint64_t          pad[7];       /* To align to cache line size */
+	volatile uint64_t seq;          /* Sequence number of the data held */
+	uint64_t          pad[6];       /* To align to cache line size */
 } flash_scratchpad_seg_status_t;
 
 /*
@@ -188,6 +189,8 @@ typedef struct {
 	uint32_t  data_addr_max;
 	/* Index of the data segment within the data block of the scratchpad */
 	uint32_t  data_seg_idx;
+	/* Sequence number of the data segment to read next */
+	uint32_t  data_seg_seq;
 	/* Index of the data block to read from the scratchpad */
 	uint32_t  data_rd_idx;
 	/* Index of the available scratchpad slot to write to */
@@ -199,6 +202,12 @@ typedef struct {
 static flash_scratchpad_desc_t gbl_flash_scratchpad;
 
 CASSERT(FLASH_SCRATCHPAD_DATA_CNT > 0, assert_flash_scratchpad_data_cnt);
+#ifdef FLASH_ENGINE_ENABLED
+CASSERT(FLASH_SCRATCHPAD_SEGMENT_DATA_CNT > 0,
+	assert_flash_scratchpad_segment_data_cnt);
+CASSERT(sizeof(flash_scratchpad_seg_status_t) == 64,
+	assert_flash_scratchpad_seg_status_size);
+#endif
 
 int flash_io_setup_scratchpad(void)
 {
@@ -207,6 +216,7 @@ int flash_io_setup_scratchpad(void)
 	/* Initialize the scratchpad */
 	scratchpad->data_addr_max = scratchpad->data_addr_start = 0;
 	scratchpad->data_seg_idx  = 0;
+	scratchpad->data_seg_seq  = 0;
 	scratchpad->data_wr_idx   = scratchpad->data_rd_idx     = 0;
 	scratchpad->is_valid      = 1;
 
@@ -279,6 +289,9 @@ static inline uint32_t *flash_scratchpad_get_data_ptr(uint32_t  data_idx,
 	while (scratch_hdr[seg_idx].is_empty == 1)
 		;
 
+	/* The engine fills the segments in order; make sure of it. */
+	assert(scratch_hdr[seg_idx].seq == scratchpad->data_seg_seq);
+
 	/* Get a pointer to the available data in the SRAM. */
 	seg_addr   = FLASH_SCRATCHPAD_DATA_BASE +
 		(seg_idx * FLASH_SCRATCHPAD_SEGMENT_DATA_SIZE);
@@ -305,6 +318,7 @@ static inline uint32_t *flash_scratchpad_get_data_ptr(uint32_t  data_idx,
 		seg_idx += 1;
 		seg_idx %= FLASH_SCRATCHPAD_SEGMENT_CNT;
 		scratchpad->data_seg_idx = seg_idx;
+		scratchpad->data_seg_seq++;
 	}
 
 	data_ptr   = (uint32_t *) ((uintptr_t) data_addr);
@@ -884,7 +898,8 @@ void flash_io_engine_do_read(void)
 	uint32_t  chunk_word, chunk_addr, chunk_mask_addr;
 	uint32_t  img_start_addr, img_size, img_off, img_addr_end;
 	uint32_t  itoc_entry_addr, data_mask_addr;
-	uint8_t   data_idx, seg_idx;
+	uint32_t  seg_seq;
+	uint32_t  data_idx, seg_idx;
 
 	img_start_addr = flash_img_desc->img_addr;
 	img_size       = flash_img_desc->img_size;
@@ -910,19 +925,18 @@ void flash_io_engine_do_read(void)
 	chunk_mask_addr = itoc_entry_addr & ~FLASH_IMAGE_BLOCK_MASK;
 
 	seg_idx    = 0;
+	seg_seq    = 0;
 	img_off    = img_start_addr;
 	chunk_word = (FLASH_SCRATCHPAD_DATA_SIZE + 3) / 4;
 
-	while (1) {
-
-		if (img_off >= img_addr_end)
-			break;
-
-		seg_idx %= FLASH_SCRATCHPAD_SEGMENT_CNT;
-		if (scratch_hdr[seg_idx].is_empty == 0) {
-			seg_idx++;
-			continue;
-		}
+	while (img_off < img_addr_end) {
+		/*
+		 * Segments are filled in order, so that the main core can
+		 * consume them in order; wait for the next one to be
+		 * released.
+		 */
+		while (scratch_hdr[seg_idx].is_empty == 0)
+			;
 
 		/* Get the start address of the data segment */
 		chunk_addr = seg_addr[seg_idx];
@@ -963,10 +977,11 @@ void flash_io_engine_do_read(void)
 		}
 
 		/* Mark the segment as full */
+		scratch_hdr[seg_idx].seq      = seg_seq++;
 		scratch_hdr[seg_idx].is_empty = 0;
 		flush_dcache_range((uintptr_t) (scratch_hdr + seg_idx),
 				   sizeof(flash_scratchpad_seg_status_t));
-		seg_idx++;
+		seg_idx = (seg_idx + 1) % FLASH_SCRATCHPAD_SEGMENT_CNT;
 	}
 
 	/* All work done; reset the flash engine and exit */
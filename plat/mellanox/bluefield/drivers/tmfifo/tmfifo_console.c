@@ -6,6 +6,7 @@
  */
 
 #include <console.h>
+#include <debug.h>
 #include <mmio.h>
 #include <string.h>
 #include <utils_def.h>
@@ -21,73 +22,135 @@
  */
 int console_register(console_t *console);
 
-/* The message header we use to send out one character. */
-const tmfifo_msg_header_t tx_header = {
-	.type = TMFIFO_MSG_CONSOLE,
-	.len_lo = 1,
-};
+/* How long (in RSH_UPTIME ticks) flush waits for the fifo to make room. */
+#define TMFIFO_FLUSH_TIMEOUT	(BF_REF_CLK_IN_HZ / 1000)
 
-/* Return 1 if the tx tmfifo can't handle any more packet of 2 word size. */
-static __inline int tmfifo_tx_full(uintptr_t tx_sts)
+/* How often (in RSH_UPTIME ticks) the first second's output is sent out. */
+#define TMFIFO_EARLY_DRAIN_INTERVAL	(BF_REF_CLK_IN_HZ / 10)
+
+/*
+ * After the Arm side resets, the host side disconnects and reconnects the
+ * Rshim driver. In this short interval, it is not actively draining the
+ * tmfifo buffer, so during the first 1 second after a soft reset we don't
+ * send each line as it ends but only every TMFIFO_EARLY_DRAIN_INTERVAL,
+ * packing as many characters as possible in each message so that the
+ * tmfifo is not full by the time the host side starts to drain it again.
+ * Error records still go out as soon as they end, as they are likely the
+ * last thing printed before a hang.
+ */
+static int host_draining; /* Set to 1 once past the first second. */
+static uint64_t early_drain_time; /* RSH_UPTIME of the last early drain. */
+static int tx_urgent; /* Set while printing an error record. */
+
+/* Number of chars in the tx ring buffer. */
+static __inline unsigned int tmfifo_tx_count(console_tmfifo_t *console)
 {
-	return (mmio_read_64(tx_sts) > (0x100 - 2));
+	return console->tx_head - console->tx_tail;
 }
 
-int console_tmfifo_putc(int character, struct console *cons)
+/* Return the number of free words in the tx tmfifo. */
+static __inline unsigned int tmfifo_tx_space(uintptr_t tx_sts)
 {
-	/*
-	 * After the Arm side resets, the host side disconnects and reconnects
-	 * the Rshim driver. In this short interval, it is not actively draining
-	 * the tmfifo buffer, and thus some of the ATF BL2 boot messages are
-	 * lost. So during the first 1 second after a soft reset, we buffer and
-	 * densely package the console message so that the tmfifo is not full
-	 * by the time the host side starts to drain it again.
-	 */
-	static int no_buffer; /* Set to 1 to stop buffering console message. */
+	uint64_t inflight = mmio_read_64(tx_sts);
 
-	console_tmfifo_t *console = (console_tmfifo_t *)cons;
+	return inflight < TMFIFO_TX_FIFO_DEPTH ?
+	       TMFIFO_TX_FIFO_DEPTH - inflight : 0;
+}
 
-	/* Prepend \r to \n */
-	if (character == '\n')
-		console_tmfifo_putc('\r', cons);
-	/*
-	 * If the tmfifo is full, it probably means that the other side is
-	 * not actively draining the fifo, thus it doesn't care about getting
-	 * the latest output, so dropping it would be okay.
-	 */
-	if (no_buffer) {
-		if (!tmfifo_tx_full(console->tx_sts_addr)) {
-			mmio_write_64(console->tx_data_addr, tx_header.data);
-			mmio_write_64(console->tx_data_addr, character & 0xff);
+/*
+ * Move as much of the tx ring buffer as the tmfifo has room for into
+ * console messages. Return the number of chars sent.
+ */
+static unsigned int tmfifo_tx_drain(console_tmfifo_t *console)
+{
+	unsigned int sent = 0;
+
+	while (tmfifo_tx_count(console) > 0) {
+		unsigned int space = tmfifo_tx_space(console->tx_sts_addr);
+		unsigned int len;
+
+		/* We need room for the header and at least one word. */
+		if (space < 2)
+			break;
+
+		len = MIN(tmfifo_tx_count(console), (space - 1) * 8);
+		len = MIN(len, (unsigned int)TMFIFO_MSG_MAX_LEN);
+
+		tmfifo_msg_header_t tx_header = {
+			.type = TMFIFO_MSG_CONSOLE,
+			.len_hi = len >> 8,
+			.len_lo = len & 0xff,
+		};
+
+		mmio_write_64(console->tx_data_addr, tx_header.data);
+
+		for (unsigned int i = 0; i < len; i += sizeof(uint64_t)) {
+			uint64_t chars = 0;
+
+			for (unsigned int j = 0;
+			     j < sizeof(uint64_t) && i + j < len; j++)
+				chars |= (uint64_t)console->tx_buf[
+					(console->tx_tail + i + j) &
+					(TMFIFO_TX_BUF_SIZE - 1)] << (8 * j);
+
+			mmio_write_64(console->tx_data_addr, chars);
 		}
 
-		return character;
+		console->tx_tail += len;
+		sent += len;
+	}
+
+	return sent;
+}
+
+/* Add one character to the tx ring buffer. */
+static void tmfifo_tx_add(console_tmfifo_t *console, int character)
+{
+	if (tmfifo_tx_count(console) == TMFIFO_TX_BUF_SIZE) {
+		tmfifo_tx_drain(console);
+		/*
+		 * If the tmfifo is still full, the other side is not actively
+		 * draining it, so it doesn't care about getting the oldest
+		 * output and dropping it would be okay.
+		 */
+		if (tmfifo_tx_count(console) == TMFIFO_TX_BUF_SIZE)
+			console->tx_tail++;
 	}
 
-	/* Add the new character to the tx buffer. */
-	console->tx_buf_chars |= (((uint64_t)(uint8_t)character) <<
-				 (8 * console->tx_buf_count));
-	console->tx_buf_count++;
+	console->tx_buf[console->tx_head++ & (TMFIFO_TX_BUF_SIZE - 1)] =
+		character;
+}
+
+int console_tmfifo_putc(int character, struct console *cons)
+{
+	console_tmfifo_t *console = (console_tmfifo_t *)cons;
+
+	/* Prepend \r to \n */
+	if (character == '\n')
+		tmfifo_tx_add(console, '\r');
+
+	tmfifo_tx_add(console, character);
 
 	/* See if we have already booted up for more than one second. */
-	if (mmio_read_64(RSHIM_BASE + RSH_UPTIME) > BF_REF_CLK_IN_HZ)
-		no_buffer = 1;
+	if (!host_draining) {
+		uint64_t now = mmio_read_64(RSHIM_BASE + RSH_UPTIME);
 
-	/* See if we need to flush the buffer to the tmfifo. */
-	if (no_buffer || console->tx_buf_count == sizeof(uint64_t)) {
-		tmfifo_msg_header_t tx_buf_header = {
-			.type = TMFIFO_MSG_CONSOLE,
-			.len_lo = console->tx_buf_count,
-		};
-		if (!tmfifo_tx_full(console->tx_sts_addr)) {
-			mmio_write_64(console->tx_data_addr,
-				      tx_buf_header.data);
-			mmio_write_64(console->tx_data_addr,
-				      console->tx_buf_chars);
+		if (now > BF_REF_CLK_IN_HZ) {
+			host_draining = 1;
+		} else if (now - early_drain_time >
+			   TMFIFO_EARLY_DRAIN_INTERVAL) {
+			early_drain_time = now;
+			tmfifo_tx_drain(console);
 		}
+	}
 
-		console->tx_buf_chars = 0;
-		console->tx_buf_count = 0;
+	/*
+	 * Send the output a line at a time; anything still buffered goes out
+	 * when the console is polled for input or flushed.
+	 */
+	if ((host_draining || tx_urgent) && character == '\n') {
+		tx_urgent = 0;
+		tmfifo_tx_drain(console);
 	}
 
 	return character;
@@ -97,6 +160,10 @@ int console_tmfifo_getc(struct console *cons)
 {
 	console_tmfifo_t *console = (console_tmfifo_t *)cons;
 
+	/* Whoever is waiting for input wants to see the prompt first. */
+	if (host_draining)
+		tmfifo_tx_drain(console);
+
 	/*
 	 * If not in the middle of a console message, try to read a
 	 * message from the rx_fifo and see if it's a console message
@@ -142,29 +209,35 @@ int console_tmfifo_getc(struct console *cons)
 	return ERROR_NO_PENDING_CHAR;
 }
 
+/*
+ * Called at the start of each log record, see plat_log_get_prefix(). An
+ * error record is sent out as soon as it ends, even in the first second.
+ */
+void console_tmfifo_log_level(unsigned int log_level)
+{
+	if (log_level <= LOG_LEVEL_ERROR)
+		tx_urgent = 1;
+}
+
 int console_tmfifo_flush(struct console *cons)
 {
 	console_tmfifo_t *console = (console_tmfifo_t *)cons;
+	uint64_t start = mmio_read_64(RSHIM_BASE + RSH_UPTIME);
 
 	/*
-	 * We don't flush the fifo as this will take infinite amount of time
-	 * if the other side is not actively draining the fifo. Thus here we
-	 * only need to flush what we had buffered (if any) to the fifo.
+	 * We don't wait for the fifo to be empty as this will take infinite
+	 * amount of time if the other side is not actively draining the fifo.
+	 * Thus here we only push what we had buffered (if any) to the fifo,
+	 * waiting for room as long as the other side keeps making some within
+	 * TMFIFO_FLUSH_TIMEOUT.
 	 */
-	if (console->tx_buf_count > 0) {
-		tmfifo_msg_header_t tx_buf_header = {
-			.type = TMFIFO_MSG_CONSOLE,
-			.len_lo = console->tx_buf_count,
-		};
-		if (!tmfifo_tx_full(console->tx_sts_addr)) {
-			mmio_write_64(console->tx_data_addr,
-				      tx_buf_header.data);
-			mmio_write_64(console->tx_data_addr,
-				      console->tx_buf_chars);
-		}
+	while (tmfifo_tx_count(console) > 0) {
+		uint64_t now = mmio_read_64(RSHIM_BASE + RSH_UPTIME);
 
-		console->tx_buf_chars = 0;
-		console->tx_buf_count = 0;
+		if (tmfifo_tx_drain(console))
+			start = now;
+		else if (now - start > TMFIFO_FLUSH_TIMEOUT)
+			break;
 	}
 
 	return 0;
@@ -14,6 +14,21 @@
 /* Only message type of console is needed in ATF for tmfifo. */
 #define TMFIFO_MSG_CONSOLE	3
 
+/* Number of 64-bit words the tx fifo holds. */
+#define TMFIFO_TX_FIFO_DEPTH	0x100
+/* Largest payload one message header can describe. */
+#define TMFIFO_MSG_MAX_LEN	0xffff
+
+/*
+ * Size of the ring buffer holding the console output until it's packed into
+ * messages, must be a power of 2. BL1 has little RW memory to spare.
+ */
+#ifdef IMAGE_BL1
+#define TMFIFO_TX_BUF_SIZE	1024
+#else
+#define TMFIFO_TX_BUF_SIZE	4096
+#endif
+
 /* Base tmfifo console struct. */
 typedef struct {
 	console_t console;	/* Base console struct */
@@ -26,8 +41,9 @@ typedef struct {
 	uint64_t rx_buf_chars;	/* Unconsumed console data from rx data fifo. */
 	unsigned int rx_buf_count;	/* Remaining chars from rx_buf_chars. */
 	unsigned int rx_msg_char_left;	/* Chars left from current msg. */
-	uint64_t tx_buf_chars;	/* Buffered tx char not yet sent. */
-	unsigned int tx_buf_count;	/* Unsent chars in txbuf_chars. */
+	unsigned int tx_head;	/* Free running index of next char to add. */
+	unsigned int tx_tail;	/* Free running index of next char to send. */
+	uint8_t tx_buf[TMFIFO_TX_BUF_SIZE];	/* Unsent tx chars. */
 } console_tmfifo_t;
 
 /* Tmfifo message header struct. */
@@ -51,4 +67,7 @@ int console_tmfifo_register(console_tmfifo_t *console,
 			    uintptr_t tx_data, uintptr_t tx_sts,
 			    uintptr_t rx_data, uintptr_t rx_sts);
 
+/* Tell the tmfifo consoles the log level of the record being printed. */
+void console_tmfifo_log_level(unsigned int log_level);
+
 #endif	/* __TMFIFO_CONSOLE_H__ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_BOOT_LOG_H__
+#define __BLUEFIELD_BOOT_LOG_H__
+
+#include <platform_def.h>
+
+/*
+ * The boot log keeps a copy of everything printed on the console by BL2 and
+ * BL31, one timestamped line at a time, in a region of DRAM reserved right
+ * below BL33. Its address is passed to UEFI (and BL31) in the EFI info so it
+ * can be kept away from the OS and read back from Linux. Until the DRAM is
+ * usable the output is kept in a staging buffer in the image's own RAM.
+ */
+#define BF_BOOT_LOG_SIZE		0x100000
+#define BF_BOOT_LOG_BASE		(NS_IMAGE_OFFSET - BF_BOOT_LOG_SIZE)
+
+/* Size of the staging buffer, must be a power of 2. */
+#ifdef IMAGE_BL2
+#define BF_BOOT_LOG_STAGE_SIZE		8192
+#else
+#define BF_BOOT_LOG_STAGE_SIZE		1024
+#endif
+
+/* Identifies an initialized boot log ("BFBOOTLG"). */
+#define BF_BOOT_LOG_MAGIC		0x474c544f4f424642ULL
+
+/*
+ * Console scope flag only the boot log console has; BL2 switches to it for
+ * the records too verbose for the other consoles.
+ */
+#define BF_CONSOLE_FLAG_LOG_ONLY	(U(1) << 3)
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+
+/* Header of the boot log region, followed by the text itself. */
+struct bf_boot_log {
+	uint64_t magic;
+	uint32_t size;		/* Size of the text area in bytes. */
+	uint32_t reserved;
+	uint64_t head;		/* Bytes ever written; ends at head % size. */
+	uint64_t lost;		/* Bytes dropped from the staging buffer. */
+	char text[];
+};
+
+/* The boot log is not kept in BL1, which has no DRAM to hand it over in. */
+#if defined(BF_BOOT_LOG) && !defined(IMAGE_BL1)
+
+void bf_boot_log_register(void);
+void bf_boot_log_start(uintptr_t base);
+void bf_boot_log_attach(uintptr_t base);
+uintptr_t bf_boot_log_base(void);
+void bf_boot_log_level(unsigned int log_level);
+void bf_boot_log_record_end(void);
+
+#else
+
+static inline void bf_boot_log_register(void) {}
+static inline void bf_boot_log_start(uintptr_t base) {}
+static inline void bf_boot_log_attach(uintptr_t base) {}
+static inline uintptr_t bf_boot_log_base(void) { return 0; }
+static inline void bf_boot_log_level(unsigned int log_level) {}
+static inline void bf_boot_log_record_end(void) {}
+
+#endif /* BF_BOOT_LOG */
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __BLUEFIELD_BOOT_LOG_H__ */
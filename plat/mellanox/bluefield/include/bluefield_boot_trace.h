@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_BOOT_TRACE_H__
+#define __BLUEFIELD_BOOT_TRACE_H__
+
+#include <stdint.h>
+#include "bluefield_def.h"
+
+/*
+ * Boot timestamp IDs. Each ID owns one slot in the timestamp table kept in
+ * the shared RAM; a slot holds the value of the system counter when the
+ * event was recorded, or 0 if it never was.
+ */
+#define BF_TS_BL2_ENTRY			0
+#define BF_TS_SAM_DONE			1
+#define BF_TS_HCA_AUTH_DONE		2
+#define BF_TS_MEM_START			3
+#define BF_TS_MEM_DONE			4
+#define BF_TS_PMR_DONE			5
+#define BF_TS_TRIO_DONE			6
+#define BF_TS_NVDIMM_RESTORE_DONE	7
+#define BF_TS_BL31_ENTRY		8
+#define BF_TS_BL31_PLAT_SETUP_DONE	9
+#define BF_TS_BL31_RUNTIME_SETUP	10
+#define BF_TS_STAGE_NUM			16
+
+/* Start and end (including authentication) of the loading of an image. */
+#define BF_TS_IMAGE_ID_NUM		32
+#define BF_TS_IMAGE_BASE		BF_TS_STAGE_NUM
+#define BF_TS_IMAGE_LOAD_START(id)	(BF_TS_IMAGE_BASE + 2 * (id))
+#define BF_TS_IMAGE_LOAD_END(id)	(BF_TS_IMAGE_BASE + 2 * (id) + 1)
+
+/*
+ * Start of each step of the DDR training sequence of one MSS. Step 0 is
+ * the start of the sequence and BF_TS_DDR_STEP_DONE its successful end.
+ */
+#define BF_TS_DDR_STEP_NUM		16
+#define BF_TS_DDR_STEP_DONE		(BF_TS_DDR_STEP_NUM - 1)
+#define BF_TS_DDR_BASE			(BF_TS_IMAGE_BASE + \
+					 2 * BF_TS_IMAGE_ID_NUM)
+#define BF_TS_DDR_STEP(mss, step)	(BF_TS_DDR_BASE + \
+					 (mss) * BF_TS_DDR_STEP_NUM + (step))
+
+#define BF_TS_NUM			(BF_TS_DDR_BASE + \
+					 MAX_MEM_CTRL * BF_TS_DDR_STEP_NUM)
+
+/* Identifies an initialized timestamp table ("BFBOOTTS"). */
+#define BF_TS_MAGIC			0x5354544f4f424642ULL
+
+struct bf_boot_ts {
+	uint64_t magic;
+	uint64_t ts[BF_TS_NUM];
+};
+
+void bf_boot_ts_init(void);
+void bf_boot_ts_record(unsigned int id);
+uint64_t bf_boot_ts_get(unsigned int id);
+void bf_boot_ts_dump(void);
+
+#endif /* __BLUEFIELD_BOOT_TRACE_H__ */
@@ -228,6 +228,42 @@
  */
 #define MBOX_BASE			SHARED_RAM_BASE
 
+/*
+ * Per-CPU release slots used by BL31 once a CPU has left the BL1 holding
+ * pen. Each CPU gets a cache line of its own, indexed by plat_my_core_pos(),
+ * so that parking and releasing one CPU never touches a word another CPU
+ * is polling. A slot holds:
+ *
+ * 1. The entry point the CPU jumps to when it is released.
+ *
+ * 2. A release generation, only written by the CPU issuing the cpu_on.
+ *
+ * 3. A park generation, only written by the CPU itself when it is turned
+ *    off; it copies the release generation it was last started with.
+ *
+ * 4. The system counter values around the wfi of the last suspend, kept
+ *    here for the idle statistics as the CPU runs with its cache off.
+ *
+ * A parked CPU waits for the two generations to differ. The legacy CPU
+ * bitmap above is still used for the first release of each CPU, since the
+ * holding pen in the boot ROM only knows about that.
+ */
+#define MBOX_SLOT_BASE			(MBOX_BASE + 0x40)
+#define MBOX_SLOT_SIZE			0x40
+#define MBOX_SLOT_ENTRY			0x0
+#define MBOX_SLOT_RELEASE_GEN		0x8
+#define MBOX_SLOT_PARK_GEN		0x10
+#define MBOX_SLOT_WFI_TS		0x18
+#define MBOX_SLOT_WAKE_TS		0x20
+
+/*
+ * The upper half of the shared RAM holds the boot timestamp table. It is
+ * filled in by BL2 (including the DDR engines, which run with the MMU off)
+ * and then by BL31, which keeps it around to answer the SiP service.
+ */
+#define BOOT_TS_BASE			(SHARED_RAM_BASE + 0x800)
+#define BOOT_TS_SIZE			0x400
+
 /* ARS (Address Range Scrub) structure offset within bf_efi structure. */
 #define NVDIMM_ARS_OFF			0x800
 
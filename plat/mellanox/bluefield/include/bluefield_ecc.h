@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_ECC_H__
+#define __BLUEFIELD_ECC_H__
+
+#include <stdint.h>
+
+/*
+ * DRAM ECC telemetry. BL31 polls the ECC counters of each memory controller
+ * (MSS) present, on a timer and before answering the SiP service, and keeps
+ * running totals along with the address of the error latched by the EMI.
+ * Each latched error is counted against its physical rank and bank, and
+ * logged in a ring of the last BF_ECC_RING_SIZE - 1 errors, numbered from
+ * 0 in the order they were seen.
+ */
+#define BF_ECC_BANKS			16
+#define BF_ECC_RING_SIZE		32
+
+/* Rank or bank argument of bf_ecc_get_count() selecting all of them. */
+#define BF_ECC_ALL			0xff
+
+/* One latched error. */
+struct bf_ecc_rec {
+	uint64_t ts;		/* System counter when it was polled. */
+	uint64_t addr;		/* DRAM_ERR_ADDR_1:DRAM_ERR_ADDR_0 */
+	uint32_t dram_addr;	/* Row and column. */
+	uint16_t syndrome;
+	uint8_t mss;
+	uint8_t prank : 2;
+	uint8_t bank : 4;
+	uint8_t derr : 1;	/* Uncorrectable (double) error. */
+};
+
+#ifdef BF_ECC_TELEMETRY
+
+void bf_ecc_init(void);
+void bf_ecc_poll(void);
+int bf_ecc_get_count(unsigned int mss, unsigned int prank, unsigned int bank,
+		     uint64_t *ce, uint64_t *ue);
+int bf_ecc_get_rec(uint64_t *seq, struct bf_ecc_rec *rec);
+
+#else
+
+static inline void bf_ecc_init(void) {}
+static inline void bf_ecc_poll(void) {}
+static inline int bf_ecc_get_count(unsigned int mss, unsigned int prank,
+				   unsigned int bank, uint64_t *ce,
+				   uint64_t *ue)
+{
+	return -1;
+}
+static inline int bf_ecc_get_rec(uint64_t *seq, struct bf_ecc_rec *rec)
+{
+	return -1;
+}
+
+#endif /* BF_ECC_TELEMETRY */
+
+#endif /* __BLUEFIELD_ECC_H__ */
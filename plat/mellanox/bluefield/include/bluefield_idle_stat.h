@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_IDLE_STAT_H__
+#define __BLUEFIELD_IDLE_STAT_H__
+
+#include <stdint.h>
+
+/*
+ * Idle latency statistics. For every CPU and every entry of the idle state
+ * table in bluefield_pm.c, BL31 keeps two histograms: the entry latency,
+ * from the platform suspend or standby handler to the wfi, and the exit
+ * latency, from the wake-up to the return to the normal world. A suspend
+ * is accounted to the state the CPU actually entered, after PSCI has
+ * coordinated it with the other CPUs of the cluster.
+ *
+ * Bucket 0 counts the latencies below 64 ns, bucket n those in
+ * [2^(n + 5), 2^(n + 6)) ns, and the last bucket everything above.
+ */
+#define BF_IDLE_STAT_STATES		3
+#define BF_IDLE_STAT_BUCKETS		16
+#define BF_IDLE_STAT_MIN_SHIFT		6
+
+#ifdef BF_IDLE_STAT
+
+void bf_idle_stat_enter(unsigned int state);
+void bf_idle_stat_record(uint64_t wfi_ts, uint64_t wake_ts);
+int bf_idle_stat_get(unsigned int cpu_idx, unsigned int state,
+		     unsigned int bucket, uint32_t *entry, uint32_t *exit);
+
+#else
+
+static inline void bf_idle_stat_enter(unsigned int state) {}
+static inline void bf_idle_stat_record(uint64_t wfi_ts, uint64_t wake_ts) {}
+static inline int bf_idle_stat_get(unsigned int cpu_idx, unsigned int state,
+				   unsigned int bucket, uint32_t *entry,
+				   uint32_t *exit)
+{
+	return -1;
+}
+
+#endif /* BF_IDLE_STAT */
+
+#endif /* __BLUEFIELD_IDLE_STAT_H__ */
@@ -276,6 +276,9 @@ int get_arg_str(char *const arg, int *data, char *const name, int count, ...);
 /* Get EFI information. */
 void bluefield_init_efi_info(uintptr_t addr);
 
+/* Get the memory controllers with memory from the EFI information. */
+uint32_t bluefield_efi_mss_mask(void);
+
 /* Start NVDIMM Save operation. */
 void bluefield_setup_nvdimm_save(void);
 
@@ -286,6 +289,12 @@ void bluefield_nvdimm_serror_check(void);
 typedef uint64_t (*bluefield_irq_handler)(int irq, void *arg);
 int bluefield_irq_register(int irq, void *arg, bluefield_irq_handler handler);
 int bluefield_irq_unregister(int irq, bluefield_irq_handler handler);
+int bluefield_irq_register_pcpu(int cpu_idx, int irq, void *arg,
+				bluefield_irq_handler handler);
+int bluefield_irq_unregister_pcpu(int cpu_idx, int irq,
+				  bluefield_irq_handler handler);
+void bluefield_irq_get_stats(unsigned int cpu_idx, uint32_t *spurious,
+			     uint32_t *unhandled);
 void bluefield_irq_init(void);
 void bluefield_irq_enable(unsigned int id, int enable);
 
@@ -97,6 +97,71 @@
  */
 #define MLNX_GET_TBB_FUSE_STATUS	0x82000006
 
+/*
+ * Return the timestamp recorded during boot for the event specified by the
+ * second argument (one of the BF_TS_* IDs in bluefield_boot_trace.h), as a
+ * raw system counter value. Returns 0 if the event was not recorded, and
+ * SMCCC_INVALID_PARAMETERS for an unknown ID.
+ */
+#define MLNX_GET_BOOT_TIMESTAMP		0x82000007
+
+/*
+ * Return one bucket of the idle latency histograms of a CPU (see
+ * bluefield_idle_stat.h). The arguments are the MPIDR of the CPU, the index
+ * of the idle state in the order of the PSCI state IDs, and the bucket.
+ * Returns the number of entries into the state whose entry latency fell
+ * in the bucket, and as a second value the number of those whose exit latency
+ * did. Returns SMCCC_INVALID_PARAMETERS for an invalid argument, or if
+ * BL31 doesn't keep idle statistics.
+ */
+#define MLNX_GET_IDLE_LATENCY		0x82000008
+
+/*
+ * Run several of the queries above in a single call. The first argument
+ * is the physical address of a normal world buffer, 8-byte aligned, and
+ * the second its size, up to MLNX_BATCH_MAX_SIZE. The buffer holds a
+ * struct mlnx_batch_hdr followed by the number of struct mlnx_batch_entry
+ * it gives. Each entry names the function ID of a query and its argument;
+ * the call fills in the value the query would have returned and a status,
+ * 0 on success or the error the query would have returned instead. Only
+ * the queries returning a single value can be batched, the others fail
+ * with SMC_UNK. Returns the number of entries processed, or
+ * SMCCC_INVALID_PARAMETERS if the buffer or its header is invalid.
+ */
+#define MLNX_GET_BATCH			0x82000009
+
+/*
+ * Return the DRAM ECC error counts of a memory controller (see
+ * bluefield_ecc.h). The arguments are the index of the memory controller,
+ * a physical rank and a bank; MLNX_ECC_ALL as the bank sums up the banks
+ * of the rank, and as the rank returns the totals of the memory controller,
+ * which also count the errors whose address could not be latched. Returns
+ * the number of corrected errors, and as a second value the number of
+ * uncorrected ones. Returns SMCCC_INVALID_PARAMETERS for an invalid
+ * argument, or if BL31 doesn't collect ECC errors.
+ */
+#define MLNX_GET_ECC_COUNT		0x8200000a
+
+/*
+ * Return the DRAM ECC error numbered by the argument, counting from 0 in the
+ * order BL31 saw them. Only the last ones are kept: if the error asked for
+ * is gone, the oldest one still around is returned instead. Returns the
+ * number of the error, its address as latched by the memory controller,
+ * its location packed as described by the MLNX_ECC_REC_* values below, and
+ * the system counter value when it was collected. Returns
+ * SMCCC_INVALID_PARAMETERS if there is no error with that number or a later
+ * one yet, or if BL31 doesn't collect ECC errors.
+ */
+#define MLNX_GET_ECC_RECORD		0x8200000b
+
+/*
+ * Return the secure interrupt counts of the CPU whose MPIDR is given as the
+ * argument: the number of spurious interrupt IDs it acknowledged, and as a
+ * second value the number of secure interrupts it took with no handler
+ * registered. Returns SMCCC_INVALID_PARAMETERS for an invalid MPIDR.
+ */
+#define MLNX_GET_IRQ_STATS		0x8200000c
+
 /* SMC function IDs for SiP Service queries */
 #define MLNX_SIP_SVC_CALL_COUNT		0x8200ff00
 #define MLNX_SIP_SVC_UID		0x8200ff01
@@ -104,10 +169,10 @@
 
 /* ARM Standard Service Calls version numbers */
 #define MLNX_SVC_VERSION_MAJOR		0x0
-#define MLNX_SVC_VERSION_MINOR		0x2
+#define MLNX_SVC_VERSION_MINOR		0x7
 
 /* Number of svc calls defined. */
-#define MLNX_NUM_SVC_CALLS 10
+#define MLNX_NUM_SVC_CALLS 16
 
 /* Valid reset actions for MLNX_SET_RESET_ACTION. */
 #define MLNX_BOOT_EXTERNAL	0 /* Do not boot from eMMC */
@@ -122,7 +187,40 @@
 /* Additional parameter value to disable the MLNX_SET_SECOND_RESET_ACTION. */
 #define MLNX_BOOT_NONE		0x7fffffff /* Don't change next boot action */
 
+/* Rank or bank argument of MLNX_GET_ECC_COUNT selecting all of them. */
+#define MLNX_ECC_ALL		0xff
+
+/* Fields of the location returned by MLNX_GET_ECC_RECORD. */
+#define MLNX_ECC_REC_MSS_SHIFT		0	/* Memory controller */
+#define MLNX_ECC_REC_PRANK_SHIFT	8	/* Physical rank */
+#define MLNX_ECC_REC_BANK_SHIFT		12	/* Bank */
+#define MLNX_ECC_REC_DERR_SHIFT		16	/* 1 if uncorrected */
+#define MLNX_ECC_REC_SYNDROME_SHIFT	20	/* ECC syndrome, 10 bits */
+#define MLNX_ECC_REC_DRAM_ADDR_SHIFT	32	/* Row and column, 25 bits */
+
 /* Error values (non-zero). */
 #define SMCCC_INVALID_PARAMETERS	-2
 
+/* Layout of the MLNX_GET_BATCH buffer. */
+#define MLNX_BATCH_VERSION		1
+#define MLNX_BATCH_MAX_SIZE		0x1000
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+
+struct mlnx_batch_hdr {
+	uint32_t version;	/* MLNX_BATCH_VERSION */
+	uint32_t count;		/* Number of entries following. */
+};
+
+struct mlnx_batch_entry {
+	uint32_t fid;		/* Function ID of the query. */
+	int32_t status;		/* Filled in by the call. */
+	uint64_t arg;		/* Argument of the query, if any. */
+	uint64_t value;		/* Filled in by the call. */
+};
+
+#endif /* __ASSEMBLY__ */
+
 #endif /* __BLUEFIELD_SVC_H__ */
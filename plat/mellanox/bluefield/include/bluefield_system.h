@@ -58,6 +58,9 @@ void bf_sys_post_test(struct bf_mem_info *bmi);
 /* Read the SPD of the DIMM inserted. */
 int bf_sys_get_spd(uint8_t *spd, int offset, int len, int mss, int dimm);
 
+/* Read the SPD of the DIMM inserted over I2C, cached for the whole boot. */
+int bf_sys_spd_read(uint8_t *spd, int offset, int len, int mss, int dimm);
+
 /* Function where the user overwrites the default DDR parameters. */
 int bf_sys_ddr_get_info_user(struct ddr_params *dp);
 
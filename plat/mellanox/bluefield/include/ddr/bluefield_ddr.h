@@ -37,11 +37,14 @@
 #include <common_def.h>
 #include <debug.h>
 #include <mmio.h>
+#include <platform.h>
 #include <platform_def.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "bluefield_boot_log.h"
+#include "bluefield_ddr_engine.h"
 #include "bluefield_ddr_regs.h"
 #include "bluefield_private.h"
 
@@ -186,19 +189,30 @@ extern int ddr_reg_flag;
 		printf(__VA_ARGS__);		\
 } while (0)
 
-#define MEM_LOG(...)			do {	\
-	if (ddr_verbose_flag || ddr_log_flag)	\
-		tf_printf(__VA_ARGS__);		\
+#define MEM_LOG(...)			do {			\
+	if (ddr_verbose_flag || ddr_log_flag) {			\
+		ddr_engine_lock(DDR_ENGINE_LOCK_CONSOLE);	\
+		tf_printf(__VA_ARGS__);				\
+		ddr_engine_unlock(DDR_ENGINE_LOCK_CONSOLE);	\
+	}							\
 } while (0)
 
-#define MEM_ERR(...)			do {	\
-	if (ddr_error_flag)			\
-		ERROR(__VA_ARGS__);		\
+#define MEM_ERR(...)			do {			\
+	if (ddr_error_flag) {					\
+		ddr_engine_lock(DDR_ENGINE_LOCK_CONSOLE);	\
+		ERROR(__VA_ARGS__);				\
+		ddr_engine_unlock(DDR_ENGINE_LOCK_CONSOLE);	\
+	}							\
 } while (0)
 
-#define MEM_VERB(...)			do {	\
-	if (ddr_verbose_flag)			\
-		tf_printf(__VA_ARGS__);		\
+#define MEM_VERB(...)			do {			\
+	if (ddr_verbose_flag) {					\
+		ddr_engine_lock(DDR_ENGINE_LOCK_CONSOLE);	\
+		bf_boot_log_level(LOG_LEVEL_VERBOSE);		\
+		tf_printf(__VA_ARGS__);				\
+		bf_boot_log_record_end();			\
+		ddr_engine_unlock(DDR_ENGINE_LOCK_CONSOLE);	\
+	}							\
 } while (0)
 
 #ifdef ATF_CONSOLE
@@ -425,6 +439,9 @@ struct dimm_params {
 
 	/* Raw SPD data. */
 	uint8_t spd[SPD_SIZE];
+
+	/* Module serial number (from the upper SPD page). */
+	uint8_t serial[4];
 };
 
 /*
@@ -660,8 +677,36 @@ struct ddr_params {
 	uint32_t mr_regs[MAX_ACTIVE_RANKS][7];
 };
 
-/* The place where we store the DDR parameters for the current setup. */
-extern struct ddr_params *dp;
+/*
+ * The DDR parameters of the MSS being set up. With DDR_PARALLEL_SETUP each
+ * core setting up an MSS has its own slot, filled in once when the setup of
+ * that MSS starts. Code that needs the parameters reads the pointer once
+ * into a local dp with ddr_cur_dp() and passes it on from there.
+ */
+#ifdef DDR_PARALLEL_SETUP
+extern struct ddr_params *ddr_core_dp[PLATFORM_CORE_COUNT];
+#else
+extern struct ddr_params *ddr_cur_params;
+#endif
+
+static inline struct ddr_params *ddr_cur_dp(void)
+{
+#ifdef DDR_PARALLEL_SETUP
+	return ddr_core_dp[plat_my_core_pos()];
+#else
+	return ddr_cur_params;
+#endif
+}
+
+static inline void ddr_set_cur_dp(struct ddr_params *p)
+{
+#ifdef DDR_PARALLEL_SETUP
+	ddr_core_dp[plat_my_core_pos()] = p;
+#else
+	ddr_cur_params = p;
+#endif
+}
+
 /* Struct storing the ddr parameters. */
 extern struct ddr_params dps[MAX_MEM_CTRL];
 /*
@@ -739,6 +784,7 @@ int find_record(int reg_type, int addr_mode, int address, char *name);
 #endif
 
 int ddr_get_info(struct ddr_params *dp, uintptr_t mss_addr, int mss_num);
+int ddr_do_actual_setup(void);
 void mem_config_ndelay(uint32_t wait);
 void mem_config_write(uintptr_t base, uint32_t id, uint32_t addr,
 		      uint32_t data);
@@ -219,4 +219,6 @@ int fill_pattern(enum bist_pattern_type);
 
 int run_default_bist(uint32_t skip_mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL]);
 int init_ddr_by_bist(uint32_t skip_mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL]);
+int post_ddr_bist(uint32_t mc_mask, uint32_t mc_pr_mask[MAX_MEM_CTRL],
+		  int skip_default);
 #endif /* _BIST_H_ */
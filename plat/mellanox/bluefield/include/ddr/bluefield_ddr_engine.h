@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_DDR_ENGINE_H__
+#define __BLUEFIELD_DDR_ENGINE_H__
+
+#include <platform_def.h>
+
+/*
+ * DDR engines are secondary cores pulled out of the BL1 holding pen to run
+ * the training sequence of one MSS each, in parallel with the other MSSes.
+ * Like the flash engine they run at EL3 with the MMU and caches off, using
+ * a stack carved out of the (still unused) BL31 area, right below the
+ * flash engine stack.
+ *
+ * The stacks are as large as the flash engine one: the LRDIMM training
+ * loops alone have frames of up to 1.7 KB, with the printf path and a few
+ * more levels of calls below them. The lowest words of each stack hold a
+ * guard pattern which is checked once the training is done.
+ */
+#define DDR_ENGINE_STACK_SIZE		(32 * 1024)
+#define DDR_ENGINE_STACK_GUARD_WORDS	16
+#define DDR_ENGINE_STACK_CANARY		0x5ddec0de5ddec0deULL
+#define DDR_ENGINE_STACK_START		(BL31_BASE + MAX_BL31_SIZE - \
+					 (32 * 1024))
+
+/* Layout of one engine slot; must match struct ddr_engine_slot. */
+#define DDR_ENGINE_SLOT_SIZE		16
+#define DDR_ENGINE_SLOT_CORE		0
+
+/* Slot states. */
+#define DDR_ENGINE_IDLE			0
+#define DDR_ENGINE_LAUNCHED		1
+#define DDR_ENGINE_RUNNING		2
+#define DDR_ENGINE_DONE			3
+#define DDR_ENGINE_TIMEOUT		4
+
+/* Locks shared between the cores training different MSSes. */
+#define DDR_ENGINE_LOCK_TYU		0
+#define DDR_ENGINE_LOCK_CONSOLE		1
+#define DDR_ENGINE_LOCK_SLOT		2
+#define DDR_ENGINE_LOCK_NUM		3
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+
+struct ddr_params;
+
+#ifdef DDR_PARALLEL_SETUP
+
+struct ddr_engine_slot {
+	volatile uint32_t core;		/* Core training this MSS. */
+	volatile uint32_t state;	/* One of DDR_ENGINE_*. */
+	volatile int32_t result;	/* Return of ddr_do_actual_setup(). */
+	volatile uint32_t stack_overflow; /* Stack guard found clobbered. */
+};
+
+void ddr_engine_begin(void);
+int ddr_engine_queue(struct ddr_params *p);
+uint32_t ddr_engine_run(void);
+void ddr_engine_lock(unsigned int lock_id);
+void ddr_engine_unlock(unsigned int lock_id);
+
+#else
+
+static inline void ddr_engine_begin(void) {}
+static inline int ddr_engine_queue(struct ddr_params *p) { return 0; }
+static inline uint32_t ddr_engine_run(void) { return 0; }
+static inline void ddr_engine_lock(unsigned int lock_id) {}
+static inline void ddr_engine_unlock(unsigned int lock_id) {}
+
+#endif /* DDR_PARALLEL_SETUP */
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __BLUEFIELD_DDR_ENGINE_H__ */
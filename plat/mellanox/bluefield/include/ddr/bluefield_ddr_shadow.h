@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_DDR_SHADOW_H__
+#define __BLUEFIELD_DDR_SHADOW_H__
+
+#include <stdint.h>
+
+/*
+ * Shadow of the PHY/memory controller registers of each MSS.
+ *
+ * Every PUB access costs several EMC indirect register round-trips, and the
+ * training code does a lot of read-modify-writes on the same registers. The
+ * shadow remembers the last value software wrote to a register, so reading
+ * it back or writing the same value again doesn't go to the hardware.
+ *
+ * Only values written by software are shadowed, status registers are always
+ * read from the hardware. Anything the PHY may update on its own (training
+ * through PIR, scheduler and BIST commands, PHY resets and indirect control
+ * writes) invalidates the shadow of the MSS, and the delay line registers are
+ * only shadowed while VT compensation is inhibited.
+ */
+#define DDR_SHADOW_BITS			8
+#define DDR_SHADOW_ENTRIES		(1 << DDR_SHADOW_BITS)
+
+#ifdef DDR_REG_SHADOW
+
+int ddr_shadow_read(int type, uint32_t reg_id, uint32_t *data);
+int ddr_shadow_write(int type, uint32_t reg_id, uint32_t data);
+void ddr_shadow_invalidate(void);
+void ddr_shadow_bypass(int bypass);
+
+#else
+
+static inline int ddr_shadow_read(int type, uint32_t reg_id, uint32_t *data)
+{
+	return 0;
+}
+static inline int ddr_shadow_write(int type, uint32_t reg_id, uint32_t data)
+{
+	return 0;
+}
+static inline void ddr_shadow_invalidate(void) {}
+static inline void ddr_shadow_bypass(int bypass) {}
+
+#endif /* DDR_REG_SHADOW */
+
+#endif /* __BLUEFIELD_DDR_SHADOW_H__ */
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_DDR_STATS_H__
+#define __BLUEFIELD_DDR_STATS_H__
+
+#include <stdint.h>
+
+/*
+ * DDR register access profile.
+ *
+ * Counts, for each step of the setup sequence of each MSS, the register
+ * accesses, the polls and the delays requested by the DDR code, and prints
+ * them at the end of the setup. The counts only depend on the code and the
+ * DIMM configuration, not on how fast the platform runs, so they give a
+ * repeatable measure of the cost of the training code on the fast model as
+ * well as on silicon.
+ *
+ * To see the accesses themselves, set ddr_log_flag to get the PCI_DUMP
+ * trace of every one of them on the console alongside the profile. A trace
+ * captured that way can be replayed against a host build of the DDR code
+ * with tools/bluefield_ddr_sim, which prints the same profile.
+ */
+
+#ifdef DDR_ACCESS_STATS
+
+void ddr_stats_step(unsigned int step);
+void ddr_stats_mmio(int is_write);
+void ddr_stats_pub(int is_write);
+void ddr_stats_poll(uint32_t retries);
+void ddr_stats_delay(uint32_t ns);
+void ddr_stats_print(void);
+
+#else
+
+static inline void ddr_stats_step(unsigned int step) {}
+static inline void ddr_stats_mmio(int is_write) {}
+static inline void ddr_stats_pub(int is_write) {}
+static inline void ddr_stats_poll(uint32_t retries) {}
+static inline void ddr_stats_delay(uint32_t ns) {}
+static inline void ddr_stats_print(void) {}
+
+#endif /* DDR_ACCESS_STATS */
+
+#endif /* __BLUEFIELD_DDR_STATS_H__ */
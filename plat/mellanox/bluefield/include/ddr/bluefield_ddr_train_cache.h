@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BLUEFIELD_DDR_TRAIN_CACHE_H__
+#define __BLUEFIELD_DDR_TRAIN_CACHE_H__
+
+#include <platform_def.h>
+
+/*
+ * The DDR training cache keeps the trained PHY state of each MSS in the
+ * Trusted SRAM gap between the BL2 and BL31 images. Nothing is ever loaded
+ * there and the SRAM keeps its contents across a soft reset, so after a
+ * warm reset with the same DIMMs BL2 can restore the PHY state instead of
+ * training it again.
+ */
+#define DDR_TRAIN_CACHE_BASE		BL2_LIMIT
+#define DDR_TRAIN_CACHE_SIZE		(BL31_BASE - BL2_LIMIT)
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+#include "bluefield_ddr.h"
+
+/* Registers saved for each byte lane. */
+#define DDR_TC_DX_LCDLR_NUM		6	/* DXnLCDLR0-5, per rank */
+#define DDR_TC_DX_BDLR_NUM		10	/* DXnBDLR0-9 */
+#define DDR_TC_DX_GCR_NUM		5	/* DXnGCR5-9 (VREF) */
+
+struct ddr_train_cache_entry {
+	/* DDR_TRAIN_CACHE_MAGIC if this entry is in use. */
+	uint32_t magic;
+	/* CRC32 of everything in the entry after this field. */
+	uint32_t crc;
+	/* Identifies the DIMMs and speed the results were trained for. */
+	uint32_t key;
+	uint32_t active_ranks;
+	uint32_t lcdlr[MAX_ACTIVE_RANKS][BYTELANE_NUM][DDR_TC_DX_LCDLR_NUM];
+	uint32_t gtr0[MAX_ACTIVE_RANKS][BYTELANE_NUM];
+	uint32_t bdlr[BYTELANE_NUM][DDR_TC_DX_BDLR_NUM];
+	uint32_t gcr[BYTELANE_NUM][DDR_TC_DX_GCR_NUM];
+	uint32_t vtdr;
+	uint32_t ext_mc_latency;	/* EMC_EXT_MC_LATENCY */
+	uint32_t mr6[MAX_ACTIVE_RANKS];
+	uint32_t mr6_vref[MAX_ACTIVE_RANKS][BYTELANE_NUM];
+	uint32_t mr6_vref_x4[MAX_ACTIVE_RANKS][BYTELANE_NUM];
+};
+
+#define DDR_TRAIN_CACHE_MAGIC		0x43544442	/* "BDTC" */
+
+#ifdef DDR_TRAIN_CACHE
+
+int ddr_train_cache_lookup(void);
+void ddr_train_cache_restore_mr(void);
+int ddr_train_cache_restore_phy(void);
+void ddr_train_cache_save(void);
+void ddr_train_cache_invalidate(void);
+
+#else
+
+static inline int ddr_train_cache_lookup(void) { return 0; }
+static inline void ddr_train_cache_restore_mr(void) {}
+static inline int ddr_train_cache_restore_phy(void) { return 0; }
+static inline void ddr_train_cache_save(void) {}
+static inline void ddr_train_cache_invalidate(void) {}
+
+#endif /* DDR_TRAIN_CACHE */
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __BLUEFIELD_DDR_TRAIN_CACHE_H__ */
@@ -34,7 +34,11 @@
 #define BFB_IMGHDR_MAGIC	0x13026642  /* "Bf^B^S" */
 
 #define BFB_IMGHDR_MAJOR	1
-#define BFB_IMGHDR_MINOR	1
+#define BFB_IMGHDR_MINOR	2
+
+/* Values of the compression field. */
+#define BFB_IMGHDR_COMP_NONE	0
+#define BFB_IMGHDR_COMP_GZIP	1
 
 /*
  * Boot stream format
@@ -71,11 +75,20 @@ union boot_image_header {
 		 * process the new header.
 		 */
 		unsigned long minor:4;
+		/*
+		 * How the image is compressed, one of BFB_IMGHDR_COMP_*
+		 * (added in version 1.2).  If this is not zero, image_len
+		 * and image_crc describe the compressed data as it appears
+		 * in the stream, and the header has at least 4 words; the
+		 * low 32 bits of the fourth one are the length of the
+		 * image once decompressed.
+		 */
+		unsigned long compression:4;
 		/*
 		 * Reserved for future expansion.  Should be ignored by
 		 * readers and set to zero by writers.
 		 */
-		unsigned long reserved:12;
+		unsigned long reserved:8;
 		/*
 		 * Length of this header, in 8-byte words.  Software
 		 * processing the header should use this value to determine
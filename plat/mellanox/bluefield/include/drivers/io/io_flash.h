@@ -179,13 +179,15 @@ struct flash_dtoc_centent {
 #else
 /*
  * In order to parallelize the hmac calculation and the copy of the FW
- * image, we split the area where to store chunks into two segements;
- * when one segment is being read, the other segment is being written.
- * So allocate the bottom low addresses to store the segment header and
- * the segment data. The upper high addresses would contain the stack of
- * the secondary core, i.e. flash engine.
+ * image, we split the area where to store chunks into segments (two by
+ * default); while one segment is being read, the others are being
+ * written. So allocate the bottom low addresses to store the segment
+ * headers and the segment data. The upper high addresses would contain
+ * the stack of the secondary core, i.e. flash engine.
  */
+#ifndef FLASH_SCRATCHPAD_SEGMENT_CNT
 #define FLASH_SCRATCHPAD_SEGMENT_CNT    2
+#endif
 
 #define FLASH_ENGINE_STACK_SIZE    (32 * 1024) /* 32KB */
 
@@ -205,7 +207,8 @@ struct flash_dtoc_centent {
 #define FLASH_SCRATCHPAD_DATA_CNT           \
 	(FLASH_SCRATCHPAD_DATA_SIZE_MAX / FLASH_SCRATCHPAD_DATA_SIZE)
 
-#define FLASH_SCRATCHPAD_SEGMENT_DATA_CNT   (FLASH_SCRATCHPAD_DATA_CNT >> 1)
+#define FLASH_SCRATCHPAD_SEGMENT_DATA_CNT   \
+	(FLASH_SCRATCHPAD_DATA_CNT / FLASH_SCRATCHPAD_SEGMENT_CNT)
 
 #define FLASH_SCRATCHPAD_SEGMENT_DATA_SIZE  \
 	(FLASH_SCRATCHPAD_SEGMENT_DATA_CNT * FLASH_SCRATCHPAD_DATA_SIZE)
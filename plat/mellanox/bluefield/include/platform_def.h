@@ -104,35 +104,46 @@
 #define BF_IRQ_SEC_RSH_SWINT_0		32
 #define BF_IRQ_SEC_RSH_DCNT_0		38
 
+/*
+ * Secure interrupt priorities. With EL3_EXCEPTION_HANDLING, every secure
+ * interrupt is Group 0 and each of these priorities is a level of the EL3
+ * exception handling framework. Handlers run with interrupts masked and
+ * are never nested: the priority only decides which of several pending
+ * interrupts is taken first.
+ */
+#define BF_PRI_BITS			3
+#define BF_IRQ_PRI_HIGH			GIC_HIGHEST_SEC_PRIORITY
+#define BF_IRQ_PRI_NORMAL		0x20
+
 /*
  * Define a list of Group 1 Secure and Group 0 interrupts as per GICv3
  * terminology. On a GICv2 system or mode, the lists will be merged and treated
  * as Group 0 interrupts.
  */
 #define BF_G1S_IRQ_PROPS(grp) \
-	INTR_PROP_DESC(BF_IRQ_SEC_PHY_TIMER, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_PHY_TIMER, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_LEVEL), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_1, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_1, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_2, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_2, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_3, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_3, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_4, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_4, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_5, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_5, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_7, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_7, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_RSH_SWINT_0, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_RSH_SWINT_0, BF_IRQ_PRI_NORMAL, grp, \
 			GIC_INTR_CFG_LEVEL), \
-	INTR_PROP_DESC(BF_IRQ_SEC_RSH_DCNT_0, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_RSH_DCNT_0, BF_IRQ_PRI_NORMAL, grp, \
 			GIC_INTR_CFG_LEVEL)
 
 #define BF_G0_IRQ_PROPS(grp) \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_0, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_0, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE), \
-	INTR_PROP_DESC(BF_IRQ_SEC_SGI_6, GIC_HIGHEST_SEC_PRIORITY, grp, \
+	INTR_PROP_DESC(BF_IRQ_SEC_SGI_6, BF_IRQ_PRI_HIGH, grp, \
 			GIC_INTR_CFG_EDGE)
 
 #define MAP_SHARED_RAM			MAP_REGION_FLAT(		\
@@ -268,4 +279,12 @@
  */
 #define NS_IMAGE_OFFSET			(DRAM1_BASE + 0x8000000)
 
+/*
+ * Scratch DRAM used by BL2 to inflate compressed images from the boot
+ * stream; it sits right below the 1MB boot log which ends at BL33.
+ */
+#define BF_INFLATE_WORK_SIZE		0x20000
+#define BF_INFLATE_WORK_BASE		(NS_IMAGE_OFFSET - 0x100000 - \
+					 BF_INFLATE_WORK_SIZE)
+
 #endif /* __PLATFORM_DEF_H__ */
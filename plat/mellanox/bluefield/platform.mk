@@ -34,8 +34,12 @@ ARM_GIC_ARCH		:=	3
 # Errata workarounds for Cortex-A72:
 ERRATA_A72_859971	:=	1
 
-# We prefer not to use DMA for the DesignWare EMMC driver.
+# We prefer not to use DMA for the DesignWare EMMC driver; BF_EMMC_DMA=1 moves
+# the data with its internal DMA controller instead, which isn't limited to
+# transfers of the FIFO size.
+ifneq (${BF_EMMC_DMA},1)
 DEFINES			+=	-DDWMMC_NO_DMA
+endif
 
 # Macro to enable/disable the 2nd eMMC card. The 2nd eMMC card shares the same
 # gpio PIN with diag UART. Once enabled, the diag UART will be disabled.
@@ -61,6 +65,7 @@ PLAT_INCLUDES		:=	-I${BF_PLAT}/include 				\
 				-Iinclude/plat/arm/common/aarch64
 
 PLAT_BL_COMMON_SOURCES	:=	${BF_PLAT}/bluefield_common.c			\
+				${BF_PLAT}/bluefield_boot_trace.c		\
 				${BF_PLAT}/aarch64/bluefield_helpers.S		\
 				${BF_PLAT}/lib/lib.c				\
 				${BF_PLAT}/drivers/tmfifo/tmfifo_console.c	\
@@ -138,6 +143,54 @@ ifndef ALT_BL2
 
     endif
 
+    # Train the memory controllers in parallel, each on a secondary core
+    ifeq (${DDR_PARALLEL_SETUP},1)
+
+        ifneq (${USE_COHERENT_MEM},1)
+            $(error "DDR_PARALLEL_SETUP requires USE_COHERENT_MEM=1")
+        endif
+
+        $(eval $(call add_define,DDR_PARALLEL_SETUP))
+
+        BL2_SOURCES	+=	${BF_PLAT}/ddr/bluefield_ddr_engine.c		\
+				${BF_PLAT}/ddr/bluefield_ddr_engine_helpers.S	\
+				lib/locks/bakery/bakery_lock_coherent.c
+
+    endif
+
+    # Bus frequency in KHz (100, 400 or 1000) used to read the DIMM SPDs;
+    # only raise it if every device on the SPD bus supports it
+    I2C_SPD_TIMING_CONFIG_KHZ	?=	100
+    $(eval $(call add_define,I2C_SPD_TIMING_CONFIG_KHZ))
+
+    # Shadow the DDR PHY registers to skip redundant indirect accesses
+    ifeq (${DDR_REG_SHADOW},1)
+
+        $(eval $(call add_define,DDR_REG_SHADOW))
+
+        BL2_SOURCES	+=	${BF_PLAT}/ddr/bluefield_ddr_shadow.c
+
+    endif
+
+    # Print per step counts of the DDR register accesses, polls and delays
+    # made by the firmware itself (on the fast model or on a board)
+    ifeq (${DDR_ACCESS_STATS},1)
+
+        $(eval $(call add_define,DDR_ACCESS_STATS))
+
+        BL2_SOURCES	+=	${BF_PLAT}/ddr/bluefield_ddr_stats.c
+
+    endif
+
+    # Restore the DDR training results of the previous boot on warm reset
+    ifeq (${DDR_TRAIN_CACHE},1)
+
+        $(eval $(call add_define,DDR_TRAIN_CACHE))
+
+        BL2_SOURCES	+=	${BF_PLAT}/ddr/bluefield_ddr_train_cache.c
+
+    endif
+
 else
     ifeq (${ALT_BL2},init_sbkey)
         $(eval $(call add_define,INIT_SBKEY))
@@ -163,6 +216,63 @@ else
 				$(ALT_BL2_DATA_FILE)
 endif
 
+# Keep a timestamped copy of the BL2/BL31 console output in DRAM; the BL2 log
+# records more verbose than BF_BOOT_LOG_CONSOLE_LEVEL only go there. By default
+# (LOG_LEVEL_VERBOSE) the other consoles print exactly what they did without
+# the boot log.
+ifeq (${BF_BOOT_LOG},1)
+
+    $(eval $(call add_define,BF_BOOT_LOG))
+
+    BF_BOOT_LOG_CONSOLE_LEVEL	?=	50
+    $(eval $(call add_define,BF_BOOT_LOG_CONSOLE_LEVEL))
+
+    BF_BOOT_LOG_SOURCES	:=	${BF_PLAT}/bluefield_boot_log.c		\
+				${BF_PLAT}/aarch64/bluefield_boot_log_helpers.S
+
+    BL2_SOURCES		+=	${BF_BOOT_LOG_SOURCES}
+    BL31_SOURCES	+=	${BF_BOOT_LOG_SOURCES}
+
+endif
+
+# Accept gzip compressed images in the boot stream loaded by BL2; they are
+# inflated as they arrive from the rshim
+ifeq (${BF_BOOT_COMPRESS},1)
+
+    include lib/zlib/zlib.mk
+
+    $(eval $(call add_define,BF_BOOT_COMPRESS))
+
+    PLAT_INCLUDES	+=	-I${ZLIB_PATH}
+
+    BL2_SOURCES		+=	$(ZLIB_SOURCES)
+
+endif
+
+# Keep per-CPU histograms of the idle state entry and exit latencies in BL31,
+# readable through the SiP service
+ifeq (${BF_IDLE_STAT},1)
+
+    $(eval $(call add_define,BF_IDLE_STAT))
+
+    BL31_SOURCES	+=	${BF_PLAT}/bluefield_idle_stat.c
+
+endif
+
+# Collect the DRAM ECC error counts and addresses in BL31, readable through
+# the SiP service; the counters are also polled every BF_ECC_POLL_MS ms on the
+# primary CPU, 0 to only poll them when they are queried
+ifeq (${BF_ECC_TELEMETRY},1)
+
+    $(eval $(call add_define,BF_ECC_TELEMETRY))
+
+    BF_ECC_POLL_MS	?=	1000
+    $(eval $(call add_define,BF_ECC_POLL_MS))
+
+    BL31_SOURCES	+=	${BF_PLAT}/bluefield_ecc.c
+
+endif
+
 # Disable the PSCI platform compatibility layer
 ENABLE_PLAT_COMPAT	:= 	0
 
@@ -230,9 +340,32 @@ ifneq (${TRUSTED_BOARD_BOOT},0)
     $(info Including ${IMG_PARSER_LIB_MK})
     include ${IMG_PARSER_LIB_MK}
 
+    # Hash the images and certificates with the SHA-256 instructions of the
+    # ARMv8 Crypto Extension, falling back to C on cores without them.
+    # Off by default, since this also changes the hashing code of BL1,
+    # which is the image burnt into the boot ROM
+    BF_SHA256_CE	?=	0
+
+    ifeq (${BF_SHA256_CE},1)
+
+        $(eval $(call add_define,MBEDTLS_SHA256_PROCESS_ALT))
+
+        BF_SHA256_CE_SOURCES	:=	${BF_PLAT}/drivers/auth/mbedtls/mbedtls_sha256_ce.c	\
+					${BF_PLAT}/drivers/auth/mbedtls/mbedtls_sha256_ce_helpers.S
+
+        BL1_SOURCES	+=	${BF_SHA256_CE_SOURCES}
+        BL2_SOURCES	+=	${BF_SHA256_CE_SOURCES}
+
+    endif
+
     # Enable using the second core as a flash DMA engine
     DEFINES		+=	-DFLASH_ENGINE_ENABLED
 
+    # Number of segments the flash scratchpad is split into; the more
+    # segments, the further the flash engine can run ahead of the HMAC
+    FLASH_SCRATCHPAD_SEGMENT_CNT	?=	2
+    $(eval $(call add_define,FLASH_SCRATCHPAD_SEGMENT_CNT))
+
 endif
 
 include ${BF_SYS}/system.mk
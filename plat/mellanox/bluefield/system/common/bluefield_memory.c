@@ -34,6 +34,7 @@
 #include "bluefield_ddr.h"
 #include "bluefield_ddr_bist.h"
 #include "bluefield_private.h"
+#include "bluefield_system.h"
 #include "i2c_smbus.h"
 #include "tyu_def.h"
 #include "rsh.h"
@@ -53,6 +54,18 @@ static const uint8_t dimm_i2c_spd_addr[MAX_MEM_CTRL][MAX_DIMM_PER_MEM_CTRL] = {
 	{I2C_SPD_0_ADDR, I2C_SPD_1_ADDR}, {I2C_SPD_2_ADDR, I2C_SPD_3_ADDR}
 };
 
+/*
+ * The SPD EEPROMs are read over the (slow) SMBus a whole page at a time and
+ * kept here for the rest of the boot, so that the fallback configuration
+ * passes, the NVDIMM information and the console don't read them again.
+ * Only successful reads are kept; an empty slot just NACKs, which is cheap.
+ */
+#define SPD_PAGE_NUM		(I2C_SPD_SIZE / I2C_SPD_PAGE_SIZE)
+
+static uint8_t spd_cache[MAX_MEM_CTRL][MAX_DIMM_PER_MEM_CTRL][I2C_SPD_SIZE];
+static uint8_t spd_page_valid[MAX_MEM_CTRL][MAX_DIMM_PER_MEM_CTRL]
+			     [SPD_PAGE_NUM];
+
 #pragma weak bf_sys_mem_config
 /*
  * Configure particular memory controller indicated by given base address and
@@ -148,47 +161,71 @@ void bf_sys_post_test(struct bf_mem_info *bmi)
 		BIST_FAIL_ACTION();
 	}
 
-	if (!skip_default_bist) {
-		if (run_default_bist(mc_mask, mc_pr_mask)) {
+	/*
+	 * Memory stil need to be zeroed everytime to not trigger ECC errors,
+	 * which is done along with the default BIST when we run it.
+	 */
+	if (post_ddr_bist(mc_mask, mc_pr_mask, skip_default_bist)) {
+		if (skip_default_bist)
+			ERROR("Zeroing DDR memory failed!\n");
+		else
 			ERROR("DDR BIST POST failed!\n");
-			BIST_FAIL_ACTION();
-		}
-	}
-
-	/* Memory stil need to be zeroed everytime to not trigger ECC errors. */
-	if (init_ddr_by_bist(mc_mask, mc_pr_mask)) {
-		ERROR("Zeroing DDR memory failed!\n");
 		BIST_FAIL_ACTION();
 	}
 	NOTICE("DDR POST passed.\n");
 }
 
-#pragma weak bf_sys_get_spd
 /*
- * Read the SPD of the specified DIMM on the specified MSS.
- * Return the size used for the SPD, if there was no SPD there, return 0.
+ * Read len bytes at offset of the SPD of the specified DIMM on the specified
+ * MSS, going through the SPD cache.
+ * Return len, or 0 if there was no SPD there.
  */
-int bf_sys_get_spd(uint8_t *spd, int offset, int len, int mss, int dimm)
+int bf_sys_spd_read(uint8_t *spd, int offset, int len, int mss, int dimm)
 {
-	uint8_t addr;
+	uint8_t *cache = spd_cache[mss][dimm];
+	uint8_t *valid = spd_page_valid[mss][dimm];
 	int status;
 
 	memset(spd, 0, len);
 
-	addr = dimm_i2c_spd_addr[mss][dimm];
+	if (offset < 0 || len <= 0 || offset + len > I2C_SPD_SIZE)
+		return 0;
 
-	MEM_VERB("Reading SPD data for MSS%d DIMM%d\n", mss, dimm);
-	status = i2c_smbus_spd_read(addr, offset, len, spd);
+	for (int page = offset / I2C_SPD_PAGE_SIZE;
+	     page <= (offset + len - 1) / I2C_SPD_PAGE_SIZE; page++) {
+		if (valid[page])
+			continue;
 
-	if (status != 0) {
-		NOTICE("No SPD found for MSS%d DIMM slot %d.\n", mss, dimm);
-		return 0;
+		MEM_VERB("Reading SPD page %d for MSS%d DIMM%d\n",
+			 page, mss, dimm);
+		status = i2c_smbus_spd_read(dimm_i2c_spd_addr[mss][dimm],
+					    page * I2C_SPD_PAGE_SIZE,
+					    I2C_SPD_PAGE_SIZE,
+					    cache + page * I2C_SPD_PAGE_SIZE);
+		if (status != 0) {
+			NOTICE("No SPD found for MSS%d DIMM slot %d.\n",
+			       mss, dimm);
+			return 0;
+		}
+		MEM_VERB("SPD found!\n");
+		valid[page] = 1;
 	}
-	MEM_VERB("SPD found!\n");
+
+	memcpy(spd, cache + offset, len);
 
 	return len;
 }
 
+#pragma weak bf_sys_get_spd
+/*
+ * Read the SPD of the specified DIMM on the specified MSS.
+ * Return the size used for the SPD, if there was no SPD there, return 0.
+ */
+int bf_sys_get_spd(uint8_t *spd, int offset, int len, int mss, int dimm)
+{
+	return bf_sys_spd_read(spd, offset, len, mss, dimm);
+}
+
 /* By default we don't overwrite any parameters and rely on the SPD. */
 #pragma weak bf_sys_ddr_get_info_user
 int bf_sys_ddr_get_info_user(struct ddr_params *dp)
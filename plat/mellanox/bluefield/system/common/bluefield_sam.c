@@ -145,7 +145,22 @@ static int log2(int num)
 /*
  * Read and write shim registers indirectly, using the rshim mem_acc
  * widget.
+ *
+ * The widget takes a new request as soon as the send bit of the previous
+ * one has cleared, so writes are posted: we only wait for their responses
+ * when a read needs the data register, when too many are in flight, or when
+ * reg_indirect_sync() is called. Reads still complete one at a time since
+ * there is only one data register to return the result in.
  */
+
+/* Keep well below the wrap of the 8-bit response counter. */
+#define REG_INDIRECT_MAX_PENDING	64
+
+/* Number of requests sent but not yet waited for. */
+static unsigned int reg_indirect_pending;
+/* Value of RSH_MEM_ACC_RSP_CNT before the pending requests were sent. */
+static uint64_t reg_indirect_rsp_base;
+
 static void reg_indirect_setup(void)
 {
 	RSH_MEM_ACC_SETUP_t rmas = {
@@ -155,53 +170,82 @@ static void reg_indirect_setup(void)
 	mmio_write_64(RSHIM_BASE + RSH_MEM_ACC_SETUP, rmas.word);
 }
 
-static void reg_indirect_wait(uint64_t resp_count)
+/* Wait for the responses of all the requests sent so far. */
+static void reg_indirect_sync(void)
 {
+	unsigned int done, last_done = 0;
 	int retries = 1000;
 
-	while (mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_RSP_CNT) == resp_count) {
-		if (--retries < 0) {
+	while (reg_indirect_pending) {
+		done = (mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_RSP_CNT) -
+			reg_indirect_rsp_base) & RSH_MEM_ACC_RSP_CNT__VAL_MASK;
+		if (done == reg_indirect_pending)
+			break;
+		/* The timeout is for one response, not the whole lot. */
+		if (done != last_done) {
+			last_done = done;
+			retries = 1000;
+		} else if (--retries < 0) {
 			ERROR("RSH_MEM_ACC timeout\n");
 			panic();
 		}
 	}
+
+	reg_indirect_pending = 0;
 }
 
-static uint64_t read_reg_indirect(uintptr_t pa, uint8_t size)
+/* Hand one request to the widget without waiting for its response. */
+static void reg_indirect_send(uintptr_t pa, uint8_t size, uint8_t write,
+			      uint64_t data)
 {
-	uint64_t resp_count = mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_RSP_CNT);
+	RSH_MEM_ACC_CTL_t rmac;
+	int retries = 1000;
 
-	RSH_MEM_ACC_CTL_t rmac = {
-		.address = pa,
-		.size = size,
-		.send = 1,
-	};
+	if (reg_indirect_pending >= REG_INDIRECT_MAX_PENDING)
+		reg_indirect_sync();
 
-	mmio_write_64(RSHIM_BASE + RSH_MEM_ACC_CTL, rmac.word);
+	if (reg_indirect_pending == 0)
+		reg_indirect_rsp_base =
+			mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_RSP_CNT);
 
-	reg_indirect_wait(resp_count);
+	/* The previous request must have left before we reuse the data. */
+	do {
+		rmac.word = mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_CTL);
+		if (--retries < 0) {
+			ERROR("RSH_MEM_ACC timeout\n");
+			panic();
+		}
+	} while (rmac.send);
 
-	uint64_t data = mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_DATA__FIRST_WORD);
+	if (write)
+		mmio_write_64(RSHIM_BASE + RSH_MEM_ACC_DATA__FIRST_WORD, data);
 
-	return data;
-}
+	rmac.word = 0;
+	rmac.address = pa;
+	rmac.size = size;
+	rmac.write = write;
+	rmac.send = 1;
 
-static void write_reg_indirect(uintptr_t pa, uint8_t size, uint64_t data)
-{
-	uint64_t resp_count = mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_RSP_CNT);
+	mmio_write_64(RSHIM_BASE + RSH_MEM_ACC_CTL, rmac.word);
 
-	mmio_write_64(RSHIM_BASE + RSH_MEM_ACC_DATA__FIRST_WORD, data);
+	reg_indirect_pending++;
+}
 
-	RSH_MEM_ACC_CTL_t rmac = {
-		.address = pa,
-		.size = size,
-		.write = 1,
-		.send = 1,
-	};
+static uint64_t read_reg_indirect(uintptr_t pa, uint8_t size)
+{
+	reg_indirect_send(pa, size, 0, 0);
+	reg_indirect_sync();
 
-	mmio_write_64(RSHIM_BASE + RSH_MEM_ACC_CTL, rmac.word);
+	return mmio_read_64(RSHIM_BASE + RSH_MEM_ACC_DATA__FIRST_WORD);
+}
 
-	reg_indirect_wait(resp_count);
+/*
+ * The write is only posted; it completes before any later indirect read
+ * and by the next reg_indirect_sync().
+ */
+static void write_reg_indirect(uintptr_t pa, uint8_t size, uint64_t data)
+{
+	reg_indirect_send(pa, size, 1, data);
 }
 
 /*
@@ -224,6 +268,7 @@ static uint32_t read_crspace(uintptr_t pa)
  * the [DEVICES_BASE, DEVICES_BASE + DEVICES_SIZE] range; these are mapped into
  * the MMU and can be accessed via direct load and store. A few devices (e.g.
  * TRIO) do not, so we use the rshim's memory access widget to get them.
+ * Indirect writes are posted, see write_reg_indirect().
  */
 static uint64_t read_reg(uintptr_t shim_pa, uint32_t offset)
 {
@@ -417,6 +462,8 @@ void bf_sys_setup_interrupts(struct bf_dev_tbl *dev_tbl, uint32_t disabled_devs)
 		write_reg(dev_tbl[target].base_addr, RSH_INT_SETUP,
 			  RSH_INT_SETUP__GBL_ENA_MASK);
 	}
+
+	reg_indirect_sync();
 }
 
 /* Return a pmr_info struct describing the specified DIMM. */
@@ -950,5 +997,8 @@ void bf_sys_setup_trio(struct bf_dev_tbl *dev_tbl, uint32_t disabled_devs)
 		break;
 	}
 
+	/* The TRIO mappings must be in place before the bridge copy. */
+	reg_indirect_sync();
+
 	bluefield_setup_bridge_copy();
 }
@@ -14,6 +14,7 @@
 #include "bluefield_ddr_bist.h"
 #include "bluefield_def.h"
 #include "bluefield_private.h"
+#include "bluefield_system.h"
 #include "i2c_smbus.h"
 #include "io_flash.h"
 #include "platform_def.h"
@@ -23,30 +24,10 @@
 /*******************************************************************************
  * Candidates for the bf_sys_get_spd() function.
  ******************************************************************************/
-/* Read the SPD. */
+/* Read the SPD (through the per boot SPD cache). */
 static int __bf_spd_read(uint8_t *spd, int offset, int len, int mss, int dimm)
 {
-	const uint8_t dimm_i2c_spd_addr[MAX_MEM_CTRL][MAX_DIMM_PER_MEM_CTRL] = {
-		{I2C_SPD_0_ADDR, I2C_SPD_1_ADDR},
-		{I2C_SPD_2_ADDR, I2C_SPD_3_ADDR},
-	};
-	uint8_t addr;
-	int status;
-
-	memset(spd, 0, len);
-
-	addr = dimm_i2c_spd_addr[mss][dimm];
-
-	MEM_VERB("Reading SPD data for MSS%d DIMM%d\n", mss, dimm);
-	status = i2c_smbus_spd_read(addr, offset, len, spd);
-
-	if (status != 0) {
-		NOTICE("No SPD found for MSS%d DIMM slot %d.\n", mss, dimm);
-		return 0;
-	}
-	MEM_VERB("SPD found!\n");
-
-	return len;
+	return bf_sys_spd_read(spd, offset, len, mss, dimm);
 }
 
 /* Skip reading the SPD. */
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host build of the BlueField DDR setup code.
+ *
+ * The DDR sources of BL2 are built for the host against a pluggable MMIO
+ * backend, and run the setup of the requested MSSes with the given SPDs.
+ * The backend is either a plain register model, or the replay of a trace
+ * recorded on a board or on the fast model: the console output of a boot
+ * with ddr_log_flag set, which holds one PCI_DUMP line per MSS register
+ * access (record it with DDR_PARALLEL_SETUP=0 so the MSSes don't mix).
+ *
+ * The firmware is built with DDR_ACCESS_STATS, so every MSS setup ends
+ * with its per step profile of register accesses, polls and delays; the
+ * delays advance a simulated clock instead of waiting. Replaying the same
+ * trace makes for a repeatable benchmark of changes to the training code.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ddr_sim.h"
+
+/* From the firmware sources. */
+extern int ddr_verbose_flag;
+extern int ddr_log_flag;
+void *bluefield_setup_mss(uintptr_t mss_addr, int mem_ctrl_num);
+
+static void usage(const char *cmd)
+{
+	printf("Usage: %s [options]\n"
+	       "  -s MSS:DIMM:FILE  SPD of a DIMM slot (binary)\n"
+	       "  -c                use the fast model DIMM configuration "
+	       "without an SPD\n"
+	       "  -m MSS            MSS to set up, in order (default: those "
+	       "with an SPD)\n"
+	       "  -t FILE           replay the PCI_DUMP trace in FILE\n"
+	       "  -T MS             simulated time limit (default 600000)\n"
+	       "  -v                report replay mismatches, print INFO logs\n"
+	       "  -V                verbose DDR messages\n"
+	       "  -L                print the PCI_DUMP trace of the run\n",
+	       cmd);
+}
+
+int main(int argc, char *argv[])
+{
+	int mss_list[16], mss_cnt = 0, have_spd[SIM_MSS_NUM] = { 0 };
+	int mss, dimm, pos, opt, failed = 0;
+	uint64_t start;
+	void *dp;
+
+	while ((opt = getopt(argc, argv, "s:cm:t:T:vVLh")) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%d:%d:%n", &mss, &dimm, &pos) < 2 ||
+			    mss < 0 || mss >= SIM_MSS_NUM || dimm < 0 ||
+			    dimm > 1 || sim_spd_load(mss, dimm, optarg + pos))
+				goto bad;
+			have_spd[mss] = 1;
+			break;
+		case 'c':
+			sim_fm_config = 1;
+			break;
+		case 'm':
+			mss = atoi(optarg);
+			if (mss < 0 || mss >= SIM_MSS_NUM || mss_cnt == 16)
+				goto bad;
+			mss_list[mss_cnt++] = mss;
+			break;
+		case 't':
+			if (sim_replay_load(optarg))
+				return 1;
+			sim_mmio_set_ops(&sim_replay_ops);
+			break;
+		case 'T':
+			sim_set_time_limit(strtoull(optarg, NULL, 0) *
+					   1000000);
+			break;
+		case 'v':
+			sim_verbose = 1;
+			sim_log_level = 40;	/* LOG_LEVEL_INFO */
+			break;
+		case 'V':
+			ddr_verbose_flag = 1;
+			break;
+		case 'L':
+			ddr_log_flag = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			goto bad;
+		}
+	}
+
+	if (optind != argc)
+		goto bad;
+
+	if (mss_cnt == 0)
+		for (mss = 0; mss < SIM_MSS_NUM; mss++)
+			if (have_spd[mss])
+				mss_list[mss_cnt++] = mss;
+
+	if (mss_cnt == 0) {
+		fprintf(stderr, "No MSS to set up\n");
+		return 1;
+	}
+
+	for (int i = 0; i < mss_cnt; i++) {
+		mss = mss_list[i];
+		start = sim_time_ns();
+
+		dp = bluefield_setup_mss(SIM_MSS_BASE(mss), mss);
+		if (dp == NULL)
+			failed = 1;
+
+		printf("MSS%d setup %s, %llu us of simulated delays\n", mss,
+		       dp != NULL ? "done" : "failed",
+		       (unsigned long long)(sim_time_ns() - start) / 1000);
+	}
+
+	sim_mmio_report();
+
+	return failed;
+
+bad:
+	usage(argv[0]);
+	return 1;
+}
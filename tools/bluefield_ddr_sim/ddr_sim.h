@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DDR_SIM_H__
+#define __DDR_SIM_H__
+
+#include <stdint.h>
+
+/*
+ * Base address handed to the DDR code for each MSS. It only needs to be
+ * out of the way of the other blocks, as the MSS registers are decoded
+ * back into a block ID and a register address, which is what a PCI_DUMP
+ * trace records.
+ */
+#define SIM_MSS_NUM		2
+#define SIM_MSS_BASE(mss)	(0x100000000000ULL + ((uint64_t)(mss) << 32))
+#define SIM_MSS_REG_OFFSET	(1ULL << 22)
+#define SIM_MSS_REG_SIZE	(1ULL << 26)
+
+/*
+ * An MMIO backend. The 32-bit accesses of the MSS registers are also
+ * given as the block ID and register address the DDR code used.
+ */
+struct sim_mmio_ops {
+	const char *name;
+	uint64_t (*read)(uintptr_t addr, unsigned int size);
+	void (*write)(uintptr_t addr, uint64_t value, unsigned int size);
+	uint32_t (*mss_read)(int mss, uint32_t id, uint32_t reg);
+	void (*mss_write)(int mss, uint32_t id, uint32_t reg, uint32_t data);
+	void (*report)(void);
+};
+
+/* Register file keeping the last value written to each address. */
+extern const struct sim_mmio_ops sim_model_ops;
+uint64_t sim_model_read(uintptr_t addr, unsigned int size);
+void sim_model_write(uintptr_t addr, uint64_t value, unsigned int size);
+
+/* Replay of a recorded PCI_DUMP trace on top of the register model. */
+extern const struct sim_mmio_ops sim_replay_ops;
+int sim_replay_load(const char *path);
+
+void sim_mmio_set_ops(const struct sim_mmio_ops *ops);
+void sim_mmio_report(void);
+
+/* SPD of each DIMM slot, loaded from a binary file; NULL if none. */
+#define SIM_SPD_SIZE		512
+int sim_spd_load(int mss, int dimm, const char *path);
+const uint8_t *sim_spd(int mss, int dimm);
+
+/* Simulated time, advanced by the delays of the DDR code. */
+uint64_t sim_time_ns(void);
+void sim_set_time_limit(uint64_t ns);
+
+extern int sim_log_level;
+extern int sim_verbose;
+extern int sim_fm_config;
+
+#endif /* __DDR_SIM_H__ */
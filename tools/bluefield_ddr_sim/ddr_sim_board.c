@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Board hooks of the DDR code for the host build. They are built like the
+ * firmware sources, as they fill in the DDR parameters.
+ */
+
+#include <string.h>
+#include "bluefield_ddr.h"
+#include "ddr_sim.h"
+
+/* Read len bytes at offset of an SPD, as bf_sys_spd_read() does. */
+int bf_sys_get_spd(uint8_t *spd, int offset, int len, int mss, int dimm)
+{
+	const uint8_t *data = sim_spd(mss, dimm);
+
+	memset(spd, 0, len);
+
+	if (data == NULL && sim_fm_config && len < 32) {
+		/* What the fast model returns, see fm_memory.c. */
+		return 1;
+	}
+
+	if (data == NULL || offset < 0 || len <= 0 ||
+	    offset + len > SIM_SPD_SIZE)
+		return 0;
+
+	memcpy(spd, data + offset, len);
+
+	return len;
+}
+
+/*
+ * Without an SPD, optionally use the memory configuration of the fast
+ * model, so that its traces can be replayed.
+ */
+int bf_sys_ddr_get_info_user(struct ddr_params *dp)
+{
+	if (!sim_fm_config || sim_spd(dp->mss_index, 0) != NULL)
+		return 1;
+
+	dp->tck = 833333;
+	dp->type = RDIMM;
+	dp->dimm_num = 1;
+	dp->dimm[0].ranks = 2;
+	dp->dimm[0].is_nvdimm = 0;
+	dp->dimm[0].density = DENSITY_4Gbit;
+	dp->speed_bin = DDR4_2666U;
+	dp->package = PACKAGE_x4;
+	dp->ddr_3ds = 1;
+	dp->wlrdqsg_lcdl_norm = 0;
+
+	return 1;
+}
+
+int bf_sys_ddr_get_info_board(struct ddr_params *dp)
+{
+	return bf_sys_ddr_get_info_board_default(dp);
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ddr_sim.h"
+
+/*
+ * Register model: an open addressing hash table of the registers touched
+ * so far, holding the last value written to them. Registers never written
+ * read as 0.
+ */
+#define MODEL_SIZE		(1 << 16)
+
+struct model_reg {
+	uintptr_t addr;
+	uint64_t value;
+	int used;
+};
+
+static struct model_reg model[MODEL_SIZE];
+static unsigned int model_used;
+
+static struct model_reg *model_find(uintptr_t addr, int create)
+{
+	unsigned int i = (addr >> 2) * 2654435761U % MODEL_SIZE;
+
+	while (model[i].used) {
+		if (model[i].addr == addr)
+			return &model[i];
+		i = (i + 1) % MODEL_SIZE;
+	}
+
+	if (!create)
+		return NULL;
+
+	if (++model_used == MODEL_SIZE) {
+		fprintf(stderr, "Register model full\n");
+		exit(2);
+	}
+	model[i].used = 1;
+	model[i].addr = addr;
+
+	return &model[i];
+}
+
+uint64_t sim_model_read(uintptr_t addr, unsigned int size)
+{
+	struct model_reg *r = model_find(addr, 0);
+
+	if (r == NULL)
+		return 0;
+
+	return size == sizeof(uint64_t) ? r->value :
+		r->value & ((1ULL << (size * 8)) - 1);
+}
+
+void sim_model_write(uintptr_t addr, uint64_t value, unsigned int size)
+{
+	model_find(addr, 1)->value = value;
+}
+
+static uint32_t model_mss_read(int mss, uint32_t id, uint32_t reg)
+{
+	return sim_model_read(SIM_MSS_BASE(mss) + SIM_MSS_REG_OFFSET +
+			      ((uintptr_t)id << 14) + (reg << 2), 4);
+}
+
+static void model_mss_write(int mss, uint32_t id, uint32_t reg,
+			    uint32_t data)
+{
+	sim_model_write(SIM_MSS_BASE(mss) + SIM_MSS_REG_OFFSET +
+			((uintptr_t)id << 14) + (reg << 2), data, 4);
+}
+
+static void model_report(void)
+{
+	printf("Register model: %u registers touched\n", model_used);
+}
+
+const struct sim_mmio_ops sim_model_ops = {
+	.name = "model",
+	.read = sim_model_read,
+	.write = sim_model_write,
+	.mss_read = model_mss_read,
+	.mss_write = model_mss_write,
+	.report = model_report,
+};
+
+/*
+ * Trace replay. The trace is the console output of a DDR setup run with
+ * ddr_log_flag set, that is one line per MSS register access:
+ *
+ *	    1         W         <id>       <reg>          <data>
+ *	    1         R         <id>       <reg>          <data>
+ *
+ * Everything else in it is ignored. The accesses are matched in order:
+ * a read returns the data recorded for it, so polls see the same values
+ * as on the board and last as many reads. When the DDR code strays from
+ * the trace, e.g. because it skips a redundant access, the replay looks
+ * a little ahead for the same access and carries on from there. Accesses
+ * it can't find go to the register model.
+ */
+#define REPLAY_LOOKAHEAD	256
+#define REPLAY_MAX_REPORTS	10
+
+struct replay_rec {
+	char op;
+	uint32_t id;
+	uint32_t reg;
+	uint32_t data;
+	unsigned int line;
+};
+
+static struct replay_rec *recs;
+static unsigned int rec_num, rec_cur;
+static unsigned int matched, resynced, skipped, unmatched;
+
+int sim_replay_load(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	unsigned int cap = 0, line = 0;
+	char buf[256];
+
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while (fgets(buf, sizeof(buf), f) != NULL) {
+		struct replay_rec r;
+		int one;
+
+		line++;
+		if (sscanf(buf, "%d %c %x %x %x", &one, &r.op, &r.id, &r.reg,
+			   &r.data) != 5 || one != 1 ||
+		    (r.op != 'R' && r.op != 'W'))
+			continue;
+
+		if (rec_num == cap) {
+			cap = cap ? cap * 2 : 4096;
+			recs = realloc(recs, cap * sizeof(*recs));
+			if (recs == NULL) {
+				fprintf(stderr, "Out of memory\n");
+				exit(2);
+			}
+		}
+		r.line = line;
+		recs[rec_num++] = r;
+	}
+	fclose(f);
+
+	printf("Loaded %u register accesses from %s\n", rec_num, path);
+
+	return 0;
+}
+
+static int rec_match(const struct replay_rec *r, char op, uint32_t id,
+		     uint32_t reg, uint32_t data)
+{
+	return r->op == op && r->id == id && r->reg == reg &&
+	       (op == 'R' || r->data == data);
+}
+
+/* Find the given access at or after the cursor and move past it. */
+static struct replay_rec *replay_next(char op, uint32_t id, uint32_t reg,
+				      uint32_t data)
+{
+	unsigned int end = rec_cur + REPLAY_LOOKAHEAD;
+
+	if (end > rec_num)
+		end = rec_num;
+
+	for (unsigned int i = rec_cur; i < end; i++) {
+		if (!rec_match(&recs[i], op, id, reg, data))
+			continue;
+
+		if (i == rec_cur) {
+			matched++;
+		} else {
+			if (resynced++ < REPLAY_MAX_REPORTS && sim_verbose)
+				printf("replay: %c %.3x %.3x at trace line %u, "
+				       "skipped %u records\n", op, id, reg,
+				       recs[i].line, i - rec_cur);
+			skipped += i - rec_cur;
+		}
+		rec_cur = i + 1;
+		return &recs[i];
+	}
+
+	if (unmatched++ < REPLAY_MAX_REPORTS && sim_verbose)
+		printf("replay: %c %.3x %.3x %.8x not found after trace "
+		       "line %u\n", op, id, reg, data,
+		       rec_cur ? recs[rec_cur - 1].line : 0);
+
+	return NULL;
+}
+
+static uint32_t replay_mss_read(int mss, uint32_t id, uint32_t reg)
+{
+	struct replay_rec *r = replay_next('R', id, reg, 0);
+
+	if (r != NULL)
+		model_mss_write(mss, id, reg, r->data);
+
+	return model_mss_read(mss, id, reg);
+}
+
+static void replay_mss_write(int mss, uint32_t id, uint32_t reg,
+			     uint32_t data)
+{
+	replay_next('W', id, reg, data);
+	model_mss_write(mss, id, reg, data);
+}
+
+static void replay_report(void)
+{
+	model_report();
+	printf("Trace replay: %u accesses matched, %u resynced skipping %u "
+	       "records, %u not in the trace, %u records left\n",
+	       matched, resynced, skipped, unmatched, rec_num - rec_cur);
+}
+
+const struct sim_mmio_ops sim_replay_ops = {
+	.name = "replay",
+	.read = sim_model_read,
+	.write = sim_model_write,
+	.mss_read = replay_mss_read,
+	.mss_write = replay_mss_write,
+	.report = replay_report,
+};
+
+/* Dispatch of the accesses made through include/mmio.h. */
+static const struct sim_mmio_ops *mmio_ops = &sim_model_ops;
+
+void sim_mmio_set_ops(const struct sim_mmio_ops *ops)
+{
+	mmio_ops = ops;
+}
+
+void sim_mmio_report(void)
+{
+	mmio_ops->report();
+}
+
+/* Return the MSS whose registers addr is in, or -1. */
+static int mss_decode(uintptr_t addr, uint32_t *id, uint32_t *reg)
+{
+	for (int mss = 0; mss < SIM_MSS_NUM; mss++) {
+		uintptr_t off = addr - SIM_MSS_BASE(mss) - SIM_MSS_REG_OFFSET;
+
+		if (addr < SIM_MSS_BASE(mss) + SIM_MSS_REG_OFFSET ||
+		    off >= SIM_MSS_REG_SIZE)
+			continue;
+
+		*id = off >> 14;
+		*reg = (off >> 2) & 0xfff;
+		return mss;
+	}
+
+	return -1;
+}
+
+uint64_t sim_mmio_read(uintptr_t addr, unsigned int size)
+{
+	uint32_t id, reg;
+	int mss = mss_decode(addr, &id, &reg);
+
+	if (mss >= 0 && size == sizeof(uint32_t))
+		return mmio_ops->mss_read(mss, id, reg);
+
+	return mmio_ops->read(addr, size);
+}
+
+void sim_mmio_write(uintptr_t addr, uint64_t value, unsigned int size)
+{
+	uint32_t id, reg;
+	int mss = mss_decode(addr, &id, &reg);
+
+	if (mss >= 0 && size == sizeof(uint32_t))
+		mmio_ops->mss_write(mss, id, reg, value);
+	else
+		mmio_ops->write(addr, value, size);
+}
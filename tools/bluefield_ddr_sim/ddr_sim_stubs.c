@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * The firmware services the DDR code relies on, for the host build: the
+ * console, the delays (which advance the simulated time rather than
+ * waiting), the boot time trace and the SPDs.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ddr_sim.h"
+
+int sim_log_level = 20;		/* LOG_LEVEL_NOTICE */
+int sim_verbose;
+int sim_fm_config;
+
+/* Linker symbols of BL2, which the firmware headers refer to. */
+char __TEXT_START__[1], __TEXT_END__[1];
+char __RODATA_START__[1], __RODATA_END__[1];
+char __COHERENT_RAM_START__[1], __COHERENT_RAM_END__[1];
+char __BL2_END__[1];
+
+void tf_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+}
+
+/* The first character of the format is the log level of the message. */
+void tf_log(const char *fmt, ...)
+{
+	va_list args;
+
+	if (fmt[0] > sim_log_level)
+		return;
+
+	va_start(args, fmt);
+	vprintf(fmt + 1, args);
+	va_end(args);
+}
+
+void __assert(const char *file, unsigned int line, const char *assertion)
+{
+	fprintf(stderr, "ASSERT: %s:%u: %s\n", file, line, assertion);
+	abort();
+}
+
+/*
+ * Simulated time. The DDR code can poll forever on a register which never
+ * gets the expected value (e.g. past the end of the trace), so give up
+ * once the time limit is reached.
+ */
+static uint64_t time_ns;
+static uint64_t time_limit_ns = 600ULL * 1000000000ULL;
+
+uint64_t sim_time_ns(void)
+{
+	return time_ns;
+}
+
+void sim_set_time_limit(uint64_t ns)
+{
+	time_limit_ns = ns;
+}
+
+void ndelay(uint64_t nsec)
+{
+	time_ns += nsec;
+	if (time_ns > time_limit_ns) {
+		fprintf(stderr, "Simulated time limit of %llu ms reached\n",
+			(unsigned long long)time_limit_ns / 1000000);
+		sim_mmio_report();
+		exit(2);
+	}
+}
+
+void udelay(uint32_t usec)
+{
+	ndelay((uint64_t)usec * 1000);
+}
+
+void mdelay(uint32_t msec)
+{
+	ndelay((uint64_t)msec * 1000000);
+}
+
+void bf_boot_ts_record(unsigned int id)
+{
+}
+
+/* The console commands of the BIST code aren't reachable from here. */
+int ctrlc(void)
+{
+	return 0;
+}
+
+int get_arg_int(char *const arg, int *data, int is_ranged, int min, int max,
+		char *const name)
+{
+	return 0;
+}
+
+int get_arg_str(char *const arg, int *data, char *const name, int count, ...)
+{
+	return 0;
+}
+
+/* SPD contents of each DIMM slot, from the files given on the command line. */
+static uint8_t spd[SIM_MSS_NUM][2][SIM_SPD_SIZE];
+static int spd_len[SIM_MSS_NUM][2];
+
+int sim_spd_load(int mss, int dimm, const char *path)
+{
+	FILE *f = fopen(path, "rb");
+
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+	spd_len[mss][dimm] = fread(spd[mss][dimm], 1, SIM_SPD_SIZE, f);
+	fclose(f);
+
+	return spd_len[mss][dimm] > 0 ? 0 : -1;
+}
+
+const uint8_t *sim_spd(int mss, int dimm)
+{
+	return spd_len[mss][dimm] > 0 ? spd[mss][dimm] : NULL;
+}
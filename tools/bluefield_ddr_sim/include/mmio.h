@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018, Mellanox Technologies. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * Neither the name of Mellanox nor the names of its contributors may be used
+ * to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * MMIO accessors for the host build of the DDR code. This header shadows
+ * include/lib/mmio.h, so every register access of the firmware sources
+ * goes to the MMIO backend of the simulator instead of the bus.
+ */
+
+#ifndef __MMIO_H__
+#define __MMIO_H__
+
+#include <stdint.h>
+
+uint64_t sim_mmio_read(uintptr_t addr, unsigned int size);
+void sim_mmio_write(uintptr_t addr, uint64_t value, unsigned int size);
+
+static inline void mmio_write_8(uintptr_t addr, uint8_t value)
+{
+	sim_mmio_write(addr, value, sizeof(value));
+}
+
+static inline uint8_t mmio_read_8(uintptr_t addr)
+{
+	return sim_mmio_read(addr, sizeof(uint8_t));
+}
+
+static inline void mmio_write_16(uintptr_t addr, uint16_t value)
+{
+	sim_mmio_write(addr, value, sizeof(value));
+}
+
+static inline uint16_t mmio_read_16(uintptr_t addr)
+{
+	return sim_mmio_read(addr, sizeof(uint16_t));
+}
+
+static inline void mmio_write_32(uintptr_t addr, uint32_t value)
+{
+	sim_mmio_write(addr, value, sizeof(value));
+}
+
+static inline uint32_t mmio_read_32(uintptr_t addr)
+{
+	return sim_mmio_read(addr, sizeof(uint32_t));
+}
+
+static inline void mmio_write_64(uintptr_t addr, uint64_t value)
+{
+	sim_mmio_write(addr, value, sizeof(value));
+}
+
+static inline uint64_t mmio_read_64(uintptr_t addr)
+{
+	return sim_mmio_read(addr, sizeof(uint64_t));
+}
+
+static inline void mmio_clrbits_32(uintptr_t addr, uint32_t clear)
+{
+	mmio_write_32(addr, mmio_read_32(addr) & ~clear);
+}
+
+static inline void mmio_setbits_32(uintptr_t addr, uint32_t set)
+{
+	mmio_write_32(addr, mmio_read_32(addr) | set);
+}
+
+static inline void mmio_clrsetbits_32(uintptr_t addr,
+				uint32_t clear,
+				uint32_t set)
+{
+	mmio_write_32(addr, (mmio_read_32(addr) & ~clear) | set);
+}
+
+#endif /* __MMIO_H__ */